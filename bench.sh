@@ -0,0 +1,31 @@
+#!/bin/sh
+#
+# Runs generated workloads through the simulated dispatcher and reports
+# scheduler throughput in jobs per second of wall time, with the p50 and
+# p99 time taken by a pass of the scheduling loop.
+#
+# usage: bench.sh [jobs ...]   (default 10000 100000 1000000)
+#
+
+SIZES=${*:-10000 100000 1000000}
+INPUT=$(mktemp)
+LATENCY=$(mktemp)
+trap 'rm -f "$INPUT" "$LATENCY"' EXIT
+
+printf "%-8s %9s %12s %10s %10s\n" arrivals jobs jobs/sec p50_us p99_us
+for JOBS in $SIZES
+do
+	for ARRIVALS in poisson bursty diurnal
+	do
+		# Enough arrivals per second to keep four CPUs busy
+		./jobgen -n "$JOBS" -a "$ARRIVALS" -r 1.2 -P 600 > "$INPUT"
+
+		START=$(date +%s.%N)
+		./dispatcher -s -c 4 -L "$LATENCY" "$INPUT" > /dev/null
+		END=$(date +%s.%N)
+
+		awk -v jobs="$JOBS" -v arrivals="$ARRIVALS" -v start="$START" -v end="$END" '
+			/^decide/ { printf "%-8s %9d %12.0f %10.1f %10.1f\n", arrivals, jobs, jobs / (end - start), $5, $6 }
+		' "$LATENCY"
+	done
+done
@@ -6,9 +6,20 @@
  */
 
 /*
- *Notes on how to fix:
- *-after each remove, print the visualizeCDA to see exactly what's happening, along with the front, back, size and filledIndices
- *-retest extract and remove to make sure you didn't f anything up
+ *Resizing policy:
+ *-the array doubles when an insert finds it full
+ *-it halves only once a remove leaves it less than a quarter full, so after
+ * any resize it is about half full and at least size/4 further operations
+ * are needed before the next one (amortized O(1), no thrashing at a boundary)
+ *-it never shrinks below MIN_CAPACITY or below a capacity asked for with
+ * reserveCDA(); shrinkToFitCDA() drops both floors on request
+ *-every resize copies into a fresh buffer and frees the old one, leaving
+ * frontIndex at 0
+ *
+ *The live values occupy at most two runs of the circular buffer (front to
+ *the end of the array, then the start of the array), so resizes, unions
+ *and extracts move them with one or two memcpy calls rather than walking
+ *them one slot at a time.
  */
 
 #include <stdio.h>
@@ -17,265 +28,176 @@
 #include <stdlib.h>
 #include "cda.h"
 
+#define MIN_CAPACITY 8
+
 struct cda {
   void (*display)(FILE *, void*);
   int frontIndex;
-  int backIndex;
   int size;
   int filledIndices;
+  int reserved;
   void **array;
 };
 
+static int slot(CDA *items, int index) {
+  int i = items->frontIndex + index;
+  return i >= items->size ? i - items->size : i;
+}
+
+/*
+ *Copies the values, front to back, into dest.
+ */
+static void copyOut(CDA *items, void **dest) {
+  int first = items->size - items->frontIndex;
+  if (first > items->filledIndices) { first = items->filledIndices; }
+
+  memcpy(dest, items->array + items->frontIndex, first * sizeof(void*));
+  memcpy(dest + first, items->array, (items->filledIndices - first) * sizeof(void*));
+}
+
+/*
+ *Copies n values from src into consecutive circular slots starting at
+ *physical slot start. The caller guarantees the room.
+ */
+static void copyIn(CDA *items, int start, void **src, int n) {
+  int first = items->size - start;
+  if (first > n) { first = n; }
+
+  memcpy(items->array + start, src, first * sizeof(void*));
+  memcpy(items->array, src + first, (n - first) * sizeof(void*));
+}
+
+static void resizeCDA(CDA *items, int capacity) {
+  assert( capacity >= items->filledIndices && capacity > 0 );
+
+  void **tmp = malloc( capacity * sizeof(void*) );
+  assert(tmp != 0);
+
+  copyOut(items, tmp);
+
+  free(items->array);
+  items->array = tmp;
+  items->size = capacity;
+  items->frontIndex = 0;
+}
+
+static void growCDA(CDA *items, int n) {
+  if (n > items->size) { resizeCDA(items, n); }
+}
+
+static void shrinkCDA(CDA *items) {
+  int floor = items->reserved > MIN_CAPACITY ? items->reserved : MIN_CAPACITY;
+
+  if (items->size > floor && items->filledIndices < items->size / 4) {
+    int capacity = items->size / 2;
+    resizeCDA(items, capacity > floor ? capacity : floor);
+  }
+}
+
 CDA *newCDA(void (*d)(FILE *, void *)) {
     assert(sizeof(CDA) != 0);
 
     CDA *arr = malloc( sizeof(CDA) );
+    assert(arr != 0);
 
-    arr->array = malloc( 1 * sizeof(void*) );
+    arr->array = malloc( MIN_CAPACITY * sizeof(void*) );
+    assert(arr->array != 0);
     arr->display = d;
-    arr->size = 1;
+    arr->size = MIN_CAPACITY;
     arr->filledIndices = 0;
     arr->frontIndex = 0;
-    arr->backIndex = 0;
+    arr->reserved = 0;
 
     return arr;
 }
 
 void insertCDAfront(CDA *items, void *value) {
-  assert( items->size * 2 * sizeof(void*) != 0 );
+  if (items->filledIndices == items->size) { resizeCDA(items, items->size * 2); }
 
-  if (items->filledIndices == 0) {
-    items->array[items->filledIndices] = value;
-    items->frontIndex = 0;
-    items->backIndex = 0;
-  }
-  else {
-    if (items->filledIndices < items->size) {
-      if (items->frontIndex == 0) {
-        items->frontIndex = items->size - 1;
-        items->array[items->size - 1] = value;
-      }
-      else {
-        items->array[items->frontIndex - 1] = value;
-        items->frontIndex -= 1;
-      }
-    }
-    else {
-      //If there is no room in the array
-      void **tmp = malloc(items->size * 2 * sizeof(void*));
-
-      int i;
-      int origIndex = items->frontIndex;
-      for (i = 0; i < items->filledIndices; i++) {
-        tmp[i] = items->array[origIndex];
-        if (origIndex == items->size - 1) { origIndex = 0; }
-        else { origIndex += 1; }
-      }
-
-      items->backIndex = i - 1;
-      items->array = realloc( items->array, 2 * items->size * sizeof(void*));
-      items->array = tmp;
-      items->size *= 2;
-
-      items->array[items->size - 1] = value;
-      items->frontIndex = items->size - 1;
-    }
-  }
+  if (items->frontIndex == 0) { items->frontIndex = items->size - 1; }
+  else { items->frontIndex -= 1; }
 
+  items->array[items->frontIndex] = value;
   items->filledIndices += 1;
 }
 
 void insertCDAback(CDA *items, void *value) {
-  assert( items->size * 2 * sizeof(void*) != 0 );
-
-//  printf("items->filledIndices is: %d\n", items->filledIndices);
-  if (items->filledIndices == 0) {
-/******************************************************************************/
-    items->array[0] = value;
-/******************************************************************************/
-    items->backIndex = 0;
-    items->frontIndex = 0;
-  }
-  else {
-    if (items->filledIndices < items->size) {
-      //If there is room in the array
-      if (items->backIndex == items->size - 1) {
-        items->backIndex = 0;
-        items->array[items->backIndex] = value;
-      }
-      else {
-        items->array[items->backIndex + 1] = value;
-        items->backIndex += 1;
-      }
-    }
-    else {
-      //Following code doubles size and then copies values w/ frontIndex = 0
-      void **tmp = malloc(items->size * 2 * sizeof(void*));
-
-      int i;
-      int origIndex = items->frontIndex;
-      for (i = 0; i < items->filledIndices; i++) {
-        tmp[i] = items->array[origIndex];
-        if (origIndex == items->size - 1) { origIndex = 0; }
-        else { origIndex += 1; }
-      }
-
-      items->backIndex = items->filledIndices;
-      items->frontIndex = 0;
-      items->array = realloc( items->array, 2 * items->size * sizeof(void*));
-      items->array = tmp;
-      items->size *= 2;
-
-      items->array[items->filledIndices] = value;
-    }
-  }
+  if (items->filledIndices == items->size) { resizeCDA(items, items->size * 2); }
 
+  items->array[slot(items, items->filledIndices)] = value;
   items->filledIndices += 1;
 }
 
 void *removeCDAfront(CDA *items) {
   assert( items->filledIndices > 0 );
 
-  void *valToReturn = NULL;
-
-  if (items->filledIndices == 0) {
-    items->backIndex = 0;
-    items->frontIndex = 0;
-    valToReturn = NULL;
-  }
-  else {
-    if (items->filledIndices - 1 < .25 * items->size) {
-      /*
-       *The following code creates a new tmpArray and fills it with all the non NULL
-       *values in the original array. It then cuts the size of the items->array (the
-       *actual object) by /2. It then repopulates the resized array with tmpArray, so
-       *every resized array will have a frontIndex of 0 and a backIndex of filledIndices
-       *minus one. Removing the requested value happens after this "if" code block.
-       */
-      void **tmp = malloc ( items->size/2 * sizeof(void*) );
-
-      int i;
-      int origIndex = items->frontIndex;
-      for (i = 0; i < items->filledIndices; i++) {
-        tmp[i] = items->array[origIndex];
-        if (origIndex == items->size - 1) { origIndex = 0; }
-        else { origIndex += 1; }
-      }
-
-      items->size /= 2;
-      items->array = realloc( items->array, items->size * sizeof(void*) );
-      items->array = tmp;
-      items->frontIndex = 0;
-      items->backIndex = items->filledIndices - 2;
-    }
+  void *valToReturn = items->array[items->frontIndex];
+  items->array[items->frontIndex] = NULL;
+  items->filledIndices -= 1;
 
-    valToReturn = items->array[items->frontIndex];
-    items->array[items->frontIndex] = NULL;
-    items->filledIndices -= 1;
+  if (items->frontIndex + 1 == items->size) { items->frontIndex = 0; }
+  else { items->frontIndex += 1; }
 
-    if (items->frontIndex + 1 == items->size) { items->frontIndex = 0; }
-    else { items->frontIndex += 1; }
-  }
+  shrinkCDA(items);
 
   return valToReturn;
 }
-void *removeCDAback(CDA *items) {
-  assert(items->filledIndices > 0);
 
-  void *valToReturn = NULL;
-
-  if (items->filledIndices == 0) {
-    items->backIndex = 0;
-    items->frontIndex = 0;
-    return NULL;
-  }
-
-  else {
-    if (items->filledIndices - 1 < .25 * items->size) {
-      /*
-       *The following code creates a new tmpArray and fills it with all the non NULL
-       *values in the original array. It then cuts the size of the items->array (the
-       *actual object) by /2. It then repopulates the resized array with tmpArray, so
-       *every resized array will have a frontIndex of 0 and a backIndex of filledIndices
-       *minus one. Removing the requested value happens after this "if" code block.
-       */
-
-      void **tmp = malloc ( items->size/2 * sizeof(void*) );
-
-      int i;
-      int origIndex = items->frontIndex;
-      for (i = 0; i < items->filledIndices; i++) {
-        tmp[i] = items->array[origIndex];
-        if (origIndex == items->size - 1) { origIndex = 0; }
-        else { origIndex += 1; }
-      }
-
-      items->size /= 2;
-      items->array = realloc( items->array, items->size * sizeof(void*) );
-      items->array = tmp;
-      items->frontIndex = 0;
-      items->backIndex = items->filledIndices - 1;
-    }
+void *removeCDAback(CDA *items) {
+  assert( items->filledIndices > 0 );
 
-    valToReturn = items->array[items->backIndex];
-    items->array[items->backIndex] = NULL;
+  int backIndex = slot(items, items->filledIndices - 1);
+  void *valToReturn = items->array[backIndex];
+  items->array[backIndex] = NULL;
+  items->filledIndices -= 1;
 
-    if (items->backIndex - 1 < 0) { items->backIndex = items->size - 1; }
-    else { items->backIndex -= 1; }
-  }
+  shrinkCDA(items);
 
-  items->filledIndices -= 1;
-/************************************************************************************/
-/*
-  printf("After removeCDAback(), the following: \n");
-  printf("items->filledIndices = %d\n", items->filledIndices);
-  printf("items->size = %d\n", items->size);
-  printf("frontIndex = %d\n", items->frontIndex);
-  printf("backIndex = %d\n", items->backIndex);
-*/
-/************************************************************************************/
   return valToReturn;
 }
 
 void unionCDA(CDA *recipient,CDA *donor) {
-
-  if (donor->filledIndices == 0) {
+  if (recipient->filledIndices == 0) {
+    /* nothing to keep in the recipient, so trade buffers instead of copying */
+    void **array = recipient->array;
+    int size = recipient->size;
+
+    recipient->array = donor->array;
+    recipient->size = donor->size;
+    recipient->frontIndex = donor->frontIndex;
+    recipient->filledIndices = donor->filledIndices;
+
+    donor->array = array;
+    donor->size = size;
     donor->frontIndex = 0;
-    donor->backIndex = 0;
     donor->filledIndices = 0;
-    donor->size = 1;
+    donor->reserved = 0;
+    shrinkCDA(donor);
 
+    growCDA(recipient, recipient->reserved);
     return;
   }
 
-  int index = donor->frontIndex;
-
-//  printf("index is: %d\n", index);
-//  printf("element is: %d\n", donor->array[index]);
+  growCDA(recipient, recipient->filledIndices + donor->filledIndices);
 
-  int i;
+  /* the donor's values are in at most two runs; append each in one step */
+  int first = donor->size - donor->frontIndex;
+  if (first > donor->filledIndices) { first = donor->filledIndices; }
 
-//  printf("donor is: \n");
-//  visualizeCDA(stdout, donor);
+  copyIn(recipient, slot(recipient, recipient->filledIndices), donor->array + donor->frontIndex, first);
+  recipient->filledIndices += first;
+  copyIn(recipient, slot(recipient, recipient->filledIndices), donor->array, donor->filledIndices - first);
+  recipient->filledIndices += donor->filledIndices - first;
 
-//  printf("\nrecip is: \n");
-//  visualizeCDA(stdout, recipient);
-//  printf("\n");
-
-  for (i = 0; i < donor->filledIndices; i++) {
-//    printf("run %d\n", i);
-    insertCDAback(recipient, donor->array[index]);
-//    printf("after insert %d\n", i);
-    if (index + 1 == donor->size) { index = 0; }
-    else { index += 1; }
-  }
-
-  donor->array = extractCDA(donor);
+  donor->filledIndices = 0;
+  donor->frontIndex = 0;
+  donor->reserved = 0;
+  resizeCDA(donor, MIN_CAPACITY);
 }
 
 void *getCDA(CDA *items,int index) {
   assert(index >= 0 && index < items->filledIndices);
-  return items->array[items->frontIndex + index];
+  return items->array[slot(items, index)];
 }
 
 void *setCDA(CDA *items,int index,void *value) {
@@ -290,50 +212,67 @@ void *setCDA(CDA *items,int index,void *value) {
     insertCDAfront(items, value);
   }
   else {
-    valToReturn = items->array[index];
-    items->array[index] = value;
+    valToReturn = items->array[slot(items, index)];
+    items->array[slot(items, index)] = value;
   }
 
   return valToReturn;
 }
 
 void **extractCDA(CDA *items) {
-  int numIterations = items->filledIndices;
-
   if (items->filledIndices == 0) {
     return 0;
   }
 
-  assert( items->filledIndices * sizeof(void*) != 0 );
-
   void **tmp = malloc ( items->filledIndices * sizeof(void*) );
+  assert(tmp != 0);
 
-  int i;
-  int origIndex = items->frontIndex;
-  for (i = 0; i < items->filledIndices; i++) {
-    tmp[i] = items->array[origIndex];
-    if (origIndex == items->size - 1) { origIndex = 0; }
-    else { origIndex += 1; }
-  }
-
-  for (i = 0; i < numIterations; i++) {
-    removeCDAback(items);
-  }
+  copyOut(items, tmp);
 
-//  items->array = realloc( items->array, sizeof(void*) );
-
-  items->size = 1;
-  items->frontIndex = 0;
-  items->backIndex = 0;
   items->filledIndices = 0;
+  items->frontIndex = 0;
+  items->reserved = 0;
+  resizeCDA(items, MIN_CAPACITY);
 
   return tmp;
 }
 
+/*
+ *Guarantees room for n values without another resize and keeps the array
+ *from shrinking below that capacity until shrinkToFitCDA() is called.
+ */
+void reserveCDA(CDA *items,int n) {
+  if (n > items->reserved) { items->reserved = n; }
+  growCDA(items, n);
+}
+
+/*
+ *Releases spare capacity and any reservation, leaving the array exactly as
+ *large as its contents (but never empty).
+ */
+void shrinkToFitCDA(CDA *items) {
+  items->reserved = 0;
+
+  int capacity = items->filledIndices > 0 ? items->filledIndices : 1;
+  if (capacity != items->size) { resizeCDA(items, capacity); }
+}
+
 int sizeCDA(CDA *items) {
   return items->filledIndices;
 }
 
+int capacityCDA(CDA *items) {
+  return items->size;
+}
+
+/*
+ *Frees the array and its backing store, but not the values in it
+ */
+void freeCDA(CDA *items) {
+  free(items->array);
+  free(items);
+}
+
 void visualizeCDA(FILE *fp,CDA *items) {
   fprintf(fp, "(");
 
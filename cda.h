@@ -21,7 +21,11 @@ extern void unionCDA(CDA *recipient,CDA *donor);
 extern void *getCDA(CDA *items,int index);
 extern void *setCDA(CDA *items,int index,void *value);
 extern void **extractCDA(CDA *items);
+extern void reserveCDA(CDA *items,int n);
+extern void shrinkToFitCDA(CDA *items);
 extern int sizeCDA(CDA *items);
+extern int capacityCDA(CDA *items);
+extern void freeCDA(CDA *items);
 extern void visualizeCDA(FILE *,CDA *items);
 extern void displayCDA(FILE *,CDA *items);
 
@@ -0,0 +1,301 @@
+/*Microbenchmark suite for the circular dynamic array and the queue
+ *built on it. Every operation is run at sizes from 1 up to a maximum
+ *in powers of ten: insertion and removal at both ends, getCDA,
+ *unionCDA, extractCDA, enqueue and dequeue, and two workloads that
+ *oscillate across a grow or a shrink threshold. Small sizes are
+ *repeated until about a million operations have been timed.
+ *
+ *Each line reports ns per operation, allocations per run and the peak
+ *of bytes allocated and not yet freed during the timed part of a run.
+ *The counts come from wrapping malloc, realloc and free at link time
+ *(see the cdabench rule in the makefile), and the cost of reading the
+ *clock is taken off every run.
+ *
+ *usage: cdabench [max]   (default 10000000)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <malloc.h>
+#include "cda.h"
+#include "queue.h"
+
+#define TARGET_OPS 1000000
+#define OSCILLATIONS 1000000
+
+/* allocation accounting, live while counting is set */
+static int counting;
+static long allocations;
+static long liveBytes;
+static long peakBytes;
+
+extern void *__real_malloc(size_t);
+extern void *__real_realloc(void *, size_t);
+extern void __real_free(void *);
+
+void *__wrap_malloc(size_t n) {
+  void *p = __real_malloc(n);
+  if (counting && p) {
+    allocations += 1;
+    liveBytes += malloc_usable_size(p);
+    if (liveBytes > peakBytes) { peakBytes = liveBytes; }
+  }
+  return p;
+}
+
+void *__wrap_realloc(void *old, size_t n) {
+  long before = old ? malloc_usable_size(old) : 0;
+  void *p = __real_realloc(old, n);
+  if (counting && p) {
+    allocations += 1;
+    liveBytes += malloc_usable_size(p) - before;
+    if (liveBytes > peakBytes) { peakBytes = liveBytes; }
+  }
+  return p;
+}
+
+void __wrap_free(void *p) {
+  if (counting && p) { liveBytes -= malloc_usable_size(p); }
+  __real_free(p);
+}
+
+static double seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* timing and accounting of the current run */
+static double started;
+static double elapsed;
+static double overhead;    // of one startTimer()/stopTimer() pair
+
+static void startTimer(void) {
+  allocations = 0;
+  liveBytes = 0;
+  peakBytes = 0;
+  counting = 1;
+  started = seconds();
+}
+
+static void stopTimer(void) {
+  elapsed += seconds() - started - overhead;
+  counting = 0;
+}
+
+static void calibrate(void) {
+  double best = 1;
+  int i;
+  for (i = 0; i < 1000; i++) {
+    elapsed = 0;
+    startTimer();
+    stopTimer();
+    if (elapsed < best) { best = elapsed; }
+  }
+  overhead = best;
+}
+
+static CDA *filled(int n) {
+  CDA *items = newCDA(NULL);
+  int i;
+  for (i = 0; i < n; i++) { insertCDAback(items, (void *) (long) i); }
+  return items;
+}
+
+/* n values whose front has been pushed away from slot 0 */
+static CDA *wrapped(int n) {
+  CDA *items = newCDA(NULL);
+  reserveCDA(items, n);
+
+  int i;
+  for (i = 0; i < n / 2; i++) { insertCDAback(items, NULL); }
+  for (i = 0; i < n / 2; i++) { removeCDAfront(items); }
+  for (i = 0; i < n; i++) { insertCDAback(items, (void *) (long) i); }
+
+  return items;
+}
+
+/* outside the timed part, so the frees are not counted */
+static void release(CDA *items) {
+  freeCDA(items);
+}
+
+/* Each benchmark runs once at size n and returns the operations it timed */
+
+static long insertBack(int n) {
+  startTimer();
+  CDA *items = filled(n);
+  stopTimer();
+  release(items);
+  return n;
+}
+
+static long insertFront(int n) {
+  int i;
+  startTimer();
+  CDA *items = newCDA(NULL);
+  for (i = 0; i < n; i++) { insertCDAfront(items, (void *) (long) i); }
+  stopTimer();
+  release(items);
+  return n;
+}
+
+static long removeBack(int n) {
+  CDA *items = filled(n);
+  int i;
+  startTimer();
+  for (i = 0; i < n; i++) { removeCDAback(items); }
+  stopTimer();
+  release(items);
+  return n;
+}
+
+static long removeFront(int n) {
+  CDA *items = filled(n);
+  int i;
+  startTimer();
+  for (i = 0; i < n; i++) { removeCDAfront(items); }
+  stopTimer();
+  release(items);
+  return n;
+}
+
+static long get(int n) {
+  CDA *items = wrapped(n);
+  long sum = 0;
+  int i;
+  startTimer();
+  for (i = 0; i < n; i++) { sum += (long) getCDA(items, (int) ((i * 7919L) % n)); }
+  stopTimer();
+  release(items);
+  return sum >= 0 ? n : 0;
+}
+
+static long unionBoth(int n) {
+  CDA *recipient = wrapped(n);
+  CDA *donor = wrapped(n);
+  startTimer();
+  unionCDA(recipient, donor);
+  stopTimer();
+  release(recipient);
+  release(donor);
+  return n;
+}
+
+static long extract(int n) {
+  CDA *items = wrapped(n);
+  startTimer();
+  void **values = extractCDA(items);
+  stopTimer();
+  __real_free(values);
+  release(items);
+  return n;
+}
+
+/* queues cannot be freed, so one is drained and reused by every run */
+static QUEUE *reused;
+
+static long enqueueAll(int n) {
+  QUEUE *items = reused ? reused : (reused = newQUEUE(NULL));
+  int i;
+  startTimer();
+  for (i = 0; i < n; i++) { enqueue(items, (void *) (long) i); }
+  stopTimer();
+  while (sizeQUEUE(items) > 0) { dequeue(items); }
+  return n;
+}
+
+static long dequeueAll(int n) {
+  QUEUE *items = reused ? reused : (reused = newQUEUE(NULL));
+  int i;
+  for (i = 0; i < n; i++) { enqueue(items, (void *) (long) i); }
+  startTimer();
+  for (i = 0; i < n; i++) { dequeue(items); }
+  stopTimer();
+  return n;
+}
+
+/* fill until the array has just grown, then step back and forth across the line */
+static long oscillateGrow(int n) {
+  CDA *items = filled(n);
+  int capacity = capacityCDA(items);
+  while (capacityCDA(items) == capacity) { insertCDAback(items, NULL); }
+
+  int i;
+  startTimer();
+  for (i = 0; i < OSCILLATIONS; i++) {
+    removeCDAback(items);
+    insertCDAback(items, NULL);
+  }
+  stopTimer();
+  release(items);
+  return 2L * OSCILLATIONS;
+}
+
+/* empty a full array until it has just shrunk, then step back and forth */
+static long oscillateShrink(int n) {
+  CDA *items = filled(n < 64 ? 64 : n);
+  int capacity = capacityCDA(items);
+  while (capacityCDA(items) == capacity && sizeCDA(items) > 0) { removeCDAback(items); }
+
+  int i;
+  startTimer();
+  for (i = 0; i < OSCILLATIONS; i++) {
+    insertCDAback(items, NULL);
+    removeCDAback(items);
+  }
+  stopTimer();
+  release(items);
+  return 2L * OSCILLATIONS;
+}
+
+typedef struct benchmark BENCHMARK;
+struct benchmark {
+  char *name;
+  long (*run)(int);
+  int once;            // the run already times a fixed number of operations
+};
+
+static BENCHMARK benchmarks[] = {
+  { "insertCDAback", insertBack, 0 },
+  { "insertCDAfront", insertFront, 0 },
+  { "removeCDAback", removeBack, 0 },
+  { "removeCDAfront", removeFront, 0 },
+  { "getCDA", get, 0 },
+  { "unionCDA", unionBoth, 0 },
+  { "extractCDA", extract, 0 },
+  { "enqueue", enqueueAll, 0 },
+  { "dequeue", dequeueAll, 0 },
+  { "oscillate-grow", oscillateGrow, 1 },
+  { "oscillate-shrink", oscillateShrink, 1 },
+};
+
+int main(int argc, char *argv[]) {
+  int max = argc > 1 ? atoi(argv[1]) : 10000000;
+  int b, n;
+
+  calibrate();
+
+  printf("%-18s %10s %10s %12s %14s\n", "op", "size", "ns/op", "allocs/run", "peak_bytes");
+  for (b = 0; b < (int) (sizeof(benchmarks) / sizeof(benchmarks[0])); b++) {
+    for (n = 1; n <= max && n > 0; n *= 10) {
+      int runs = benchmarks[b].once || n >= TARGET_OPS ? 1 : TARGET_OPS / n;
+      long ops = 0, allocs = 0, peak = 0;
+      int r;
+
+      elapsed = 0;
+      for (r = 0; r < runs; r++) {
+        ops += benchmarks[b].run(n);
+        allocs += allocations;
+        if (peakBytes > peak) { peak = peakBytes; }
+      }
+
+      printf("%-18s %10d %10.2f %12.1f %14ld\n", benchmarks[b].name, n,
+          elapsed * 1e9 / ops, (double) allocs / runs, peak);
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,49 @@
+#!/bin/sh
+#
+# Runs small job files through the simulated dispatcher and checks the
+# event trace for scheduling regressions. Prints each failed check and
+# exits non-zero if there were any.
+#
+# usage: check.sh
+#
+
+INPUT=$(mktemp)
+TRACE=$(mktemp)
+trap 'rm -f "$INPUT" "$TRACE"' EXIT
+FAILED=0
+
+fail()
+{
+	echo "FAIL: $1"
+	FAILED=1
+}
+
+# A job suspended and restarted at the same moment was preempted for nothing
+selfRestarts()
+{
+	awk '$2 == "suspend" { last = $1 " " $3; next }
+		$2 == "restart" && $1 " " $3 == last { n++ }
+		{ last = "" }
+		END { print n + 0 }' "$TRACE"
+}
+
+# Stride: two equal-ticket jobs take turns without preempting themselves
+printf '0, 1, 3\n0, 1, 3\n' > "$INPUT"
+./dispatcher -s -a stride "$INPUT" > "$TRACE"
+[ "$(selfRestarts)" -eq 0 ] || fail "stride preempts an equal-ticket job in favour of itself"
+[ "$(awk '$2 == "restart" || $2 == "start" { printf "%s", $3 }' "$TRACE")" = "121212" ] ||
+	fail "stride does not alternate two equal-ticket jobs"
+
+# Stride: a job with more tickets keeps the CPU rather than restarting
+printf '0, 1, 4\n0, 3, 2\n' > "$INPUT"
+./dispatcher -s -a stride "$INPUT" > "$TRACE"
+[ "$(selfRestarts)" -eq 0 ] || fail "stride preempts a job with more tickets in favour of itself"
+
+# Mlfq: a priority past the lowest of -l levels is a user job at that level
+printf '0, 1, 2\n1, 3, 2\n' > "$INPUT"
+./dispatcher -s -l 2 "$INPUT" > "$TRACE"
+[ "$(selfRestarts)" -eq 0 ] || fail "mlfq preempts an out-of-range priority in favour of itself"
+[ "$(awk '$3 == 2 && $4 != 1' "$TRACE")" = "" ] ||
+	fail "mlfq does not put an out-of-range priority on the lowest level"
+
+exit $FAILED
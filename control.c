@@ -0,0 +1,168 @@
+/*This file serves as method implementations for the
+ *control channel object, a page of memory shared between
+ *the dispatcher and one child. The dispatcher writes a
+ *command word and wakes the child with a futex; the child
+ *obeys at its next safe point. A child that parks or
+ *resumes copies the command word it obeyed and signals an
+ *eventfd the dispatcher watches, so acknowledgements arrive
+ *in the dispatcher's event loop without a signal or a stop.
+ *
+ *The low two bits of the command word are the command and
+ *the rest is a sequence number, so an acknowledgement can
+ *always be matched to the request it answers.
+ */
+
+#define _GNU_SOURCE				// memfd_create
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "control.h"
+
+#define COMMAND_MASK 3
+#define SEQUENCE_STEP 4
+
+struct control {
+  unsigned command;    // written by the dispatcher
+  unsigned acked;      // written by the child: the command it last obeyed
+};
+
+static void futexWake(unsigned *word) {
+  syscall(SYS_futex, word, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+static void futexWait(unsigned *word, unsigned value, struct timespec *timeout) {
+  syscall(SYS_futex, word, FUTEX_WAIT, value, timeout, NULL, 0);
+}
+
+static CONTROL *mapControl(int fd) {
+  CONTROL *items = mmap(NULL, sizeof(CONTROL), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  return items == MAP_FAILED ? NULL : items;
+}
+
+/*
+ *Creates a channel whose first command is given. The returned fd is for
+ *handing to the child and should be closed once it has been spawned.
+ *Returns NULL when shared memory is unavailable, in which case the
+ *caller falls back to signals.
+ */
+CONTROL *newCONTROL(int command, int *fd) {
+  *fd = memfd_create("control", MFD_CLOEXEC);
+  if (*fd < 0)
+    return NULL;
+
+  CONTROL *items;
+  if (ftruncate(*fd, sizeof(CONTROL)) || !(items = mapControl(*fd))) {
+    close(*fd);
+    return NULL;
+  }
+
+  items->command = command;
+  items->acked = command == CONTROL_RUN ? (unsigned) command : ~0u;    // a running start needs no answer
+  return items;
+}
+
+/*
+ *Sets the child's command and wakes it if it is waiting
+ */
+void sendCONTROL(CONTROL *items, int command) {
+  unsigned word = __atomic_load_n(&items->command, __ATOMIC_RELAXED);
+  word = ((word & ~COMMAND_MASK) + SEQUENCE_STEP) | command;
+
+  __atomic_store_n(&items->command, word, __ATOMIC_RELEASE);
+  futexWake(&items->command);
+}
+
+/*
+ *Returns 1 if the child has parked or resumed in answer to the latest
+ *command
+ */
+int ackedCONTROL(CONTROL *items) {
+  unsigned word = __atomic_load_n(&items->command, __ATOMIC_ACQUIRE);
+  return __atomic_load_n(&items->acked, __ATOMIC_ACQUIRE) == word;
+}
+
+void freeCONTROL(CONTROL *items) {
+  munmap(items, sizeof(CONTROL));
+}
+
+/*
+ *Maps the channel a child was spawned with, or returns NULL if it was
+ *started without one and should expect signals instead
+ */
+CONTROL *openCONTROL(void) {
+  if (!getenv(CONTROL_ENV))
+    return NULL;
+  return mapControl(CONTROL_FD);
+}
+
+int commandCONTROL(CONTROL *items) {
+  return __atomic_load_n(&items->command, __ATOMIC_ACQUIRE) & COMMAND_MASK;
+}
+
+/*
+ *Sleeps for up to ms milliseconds, waking early if the command changes.
+ *Returns 0 if the whole time passed, 1 if a new command cut it short.
+ */
+int napCONTROL(CONTROL *items, long ms) {
+  unsigned word = __atomic_load_n(&items->command, __ATOMIC_ACQUIRE);
+  struct timespec start, now;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  for (;;) {
+    long elapsed;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    elapsed = (now.tv_sec - start.tv_sec) * 1000 + (now.tv_nsec - start.tv_nsec) / 1000000;
+    if (elapsed >= ms)
+      return 0;
+
+    struct timespec left = { (ms - elapsed) / 1000, ((ms - elapsed) % 1000) * 1000000L };
+    futexWait(&items->command, word, &left);
+    if (__atomic_load_n(&items->command, __ATOMIC_ACQUIRE) != word)
+      return 1;
+  }
+}
+
+static void acknowledge(CONTROL *items, unsigned word) {
+  uint64_t one = 1;
+
+  __atomic_store_n(&items->acked, word, __ATOMIC_RELEASE);
+  if (write(CONTROL_NOTIFY_FD, &one, sizeof(one)) != sizeof(one))
+    perror("control");
+}
+
+/*
+ *Acknowledges a park command and waits until told to do anything else,
+ *acknowledging the run command that ends the wait. Park commands sent
+ *while already parked are acknowledged in turn.
+ */
+void parkCONTROL(CONTROL *items) {
+  unsigned word = __atomic_load_n(&items->command, __ATOMIC_ACQUIRE);
+
+  while ((word & COMMAND_MASK) == CONTROL_PARK) {
+    acknowledge(items, word);
+
+    while (__atomic_load_n(&items->command, __ATOMIC_ACQUIRE) == word)
+      futexWait(&items->command, word, NULL);
+    word = __atomic_load_n(&items->command, __ATOMIC_ACQUIRE);
+  }
+
+  if ((word & COMMAND_MASK) == CONTROL_RUN)
+    acknowledge(items, word);
+}
+
+/*
+ *Acknowledges a run command that has not been answered yet. One sent to
+ *a pooled child before it first reached a safe point finds it running
+ *rather than parked, so parkCONTROL() never sees it.
+ */
+void runCONTROL(CONTROL *items) {
+  unsigned word = __atomic_load_n(&items->command, __ATOMIC_ACQUIRE);
+
+  if ((word & COMMAND_MASK) == CONTROL_RUN && __atomic_load_n(&items->acked, __ATOMIC_ACQUIRE) != word)
+    acknowledge(items, word);
+}
@@ -0,0 +1,31 @@
+/*This file serves as the header for the control.c file
+ */
+
+#ifndef __CONTROL_INCLUDED__
+#define __CONTROL_INCLUDED__
+
+#define CONTROL_RUN 0
+#define CONTROL_PARK 1
+#define CONTROL_EXIT 2
+
+/* where a child finds its channel and the dispatcher's notification fd */
+#define CONTROL_FD 3
+#define CONTROL_NOTIFY_FD 4
+#define CONTROL_ENV "SIGTRAP_CONTROL"
+
+typedef struct control CONTROL;
+
+/* dispatcher side */
+extern CONTROL *newCONTROL(int command,int *fd);
+extern void sendCONTROL(CONTROL *items,int command);
+extern int ackedCONTROL(CONTROL *items);
+extern void freeCONTROL(CONTROL *items);
+
+/* child side */
+extern CONTROL *openCONTROL(void);
+extern int commandCONTROL(CONTROL *items);
+extern int napCONTROL(CONTROL *items,long ms);
+extern void parkCONTROL(CONTROL *items);
+extern void runCONTROL(CONTROL *items);
+
+#endif
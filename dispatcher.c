@@ -18,37 +18,106 @@
 //		kill(process->pid, SIGCONT) for signal continue
 //		waitpid(process->pid, &status, WUNTRACED) to retain synchronization of output between your dispatcher and child process
 //			|--> your dispatcher should wait for the process to respond SIGTSTP or SIGINT before continuing
+#define _GNU_SOURCE					// sched_setaffinity and CPU_SET
 #include <stdio.h>
 #include <stdlib.h>
 #include <signal.h>
 #include <unistd.h>
 #include <string.h>
+#include <limits.h>
+#include <time.h>
+#include <getopt.h>
+#include <sched.h>
+#include <spawn.h>
 #include <sys/wait.h>
 #include <sys/types.h>
+#include <sys/signalfd.h>
+#include <sys/eventfd.h>
 
 #include "integer.h"
-#include "scanner.h"
 #include "queue.h"
+#include "cda.h"
+#include "heap.h"
+#include "mlfq.h"
+#include "policy.h"
+#include "events.h"
+#include "job.h"
+#include "jobfile.h"
+#include "stream.h"
+#include "slab.h"
+#include "control.h"
+#include "metrics.h"
+#include "histogram.h"
 
-typedef struct JOB JOB;
-struct JOB
+#define DEFAULT_QUANTUM 1000		// milliseconds
+#define DEFAULT_LEVELS 4			// system level plus user priorities 1-3
+#define EVENT_CHILD 1
+#define EVENT_STREAM 2
+#define EVENT_CONTROL 3
+#define EVENT_REPORT 4
+#define JOBS_PER_SLAB 4096
+#define AWAIT_NONE 0				// what a signalled child is expected to do next
+#define AWAIT_STOP 1
+#define AWAIT_EXIT 2
+#define AWAIT_CONT 3
+#define CHILD_LIFETIME "999999999"	// seconds; children are ended by the dispatcher, never by their own count
+
+/* A CPU the dispatcher can run one job on at a time */
+typedef struct SLOT SLOT;
+struct SLOT
+{
+	JOB *running;					// NULL when idle
+	long sliceStart;
+	long sliceEnd;
+	int core;						// core the slot's jobs are pinned to, or -1
+	void *ready;					// the slot's own ready jobs, kept by the policy
+};
+
+/* A spawned ./process and the channel it obeys, if any */
+typedef struct CHILD CHILD;
+struct CHILD
 {
 	pid_t pid;
-	char *args[3];
-	int arrivalTime;
-	int remainingProcessorTime;
-	int priority;
-	char *processorTime;
+	CONTROL *control;
 };
 
 /* Global Variables */
-JOB *running;
-QUEUE *sysQueue;
-QUEUE *p1q;
-QUEUE *p2q;
-QUEUE *p3q;
-QUEUE *jobList;
-int timer;
+SLOT *slots;
+int cpus;
+int busy;						// slots with a running job
+long steals;					// jobs an idle slot took from another slot's queue
+int levels;						// per slot: the system level plus user priorities 1+
+POLICY *policy;					// decides which ready job runs next and when to preempt
+long aging;						// milliseconds before a waiting job is promoted, 0 for never
+HEAP *jobList;					// jobs that have not arrived yet, earliest first
+long timer;						// milliseconds since the dispatcher started
+long quantum;
+EVENTS *events;
+int childfd;					// signalfd reporting SIGCHLD
+sigset_t origMask;
+int simulate;					// run against virtual time without children
+int jobCount;					// jobs admitted so far, used to number them
+SLAB *jobs;						// storage for every JOB, reused as jobs complete
+STREAM *stream;					// source of jobs submitted while running, or NULL
+int streamWatched;
+int maxQueued;					// stop reading the stream above this many queued jobs, 0 for no limit
+CHILD *pool;					// stopped or parked ./process children waiting to be handed a job
+int pooled;
+int poolSize;					// children kept in the pool, 0 to spawn one per job
+posix_spawnattr_t spawnAttr;
+CDA *signalled;					// jobs whose child has not yet acknowledged a signal
+int channel;					// drive children over shared memory rather than signals
+int notifyfd;					// eventfd children signal when they park
+char **channelEnv;				// environment children with a channel are spawned with
+METRICS *metrics;				// per-job scheduling history, or NULL when not reporting
+char *reportPath;				// where the run report goes, "-" for stdout
+int reportJSON;
+int reportfd;					// signalfd reporting SIGUSR1, which asks for the reports
+char *latencyPath;				// where the round trip latencies go, "-" for stdout
+HISTOGRAM *suspendLatency;		// nanoseconds from signal to acknowledgement
+HISTOGRAM *restartLatency;
+HISTOGRAM *terminateLatency;
+HISTOGRAM *decisionLatency;		// nanoseconds per pass of the scheduling loop
 
 
 /* Required functions */
@@ -61,38 +130,210 @@ static JOB *suspendProcess(JOB *);
 static void displayJOB(FILE *, void *);
 static void initialize(void);
 static int complete(void);
-static int priorityQueuesEmpty(void);
-static void incrementPriority(JOB *);									// Safe method for incrementing process priority
-static void readInFile(FILE *, QUEUE *);
-static void dispatchJobs(void);
-static void enqToPriority(JOB *);
-static QUEUE *getHighestPriorityQ(void);
+static int compareArrival(void *, void *);
+static void readInFile(char *);
+static void admitArrivals(void);
+static long nextArrival(void);
+static SLOT *leastLoaded(void);
+static int readyJobs(void);
+static int queued(void);
+static void admitJOB(JOB *);
+static void admitStreamed(JOB *);
+static void retire(JOB *);
+static void stopped(JOB *);
+static void awaitChild(JOB *, int);
+static void ingest(void);
+static void pinProcess(JOB *, int);
+static pid_t spawnProcess(char *, int, CONTROL **);
+static void collectAcknowledged(void);
+static void dropSignalled(int);
+static long nowNS(void);
+static void writeReport(void);
+static void writeLatency(void);
+static void fillPool(void);
+static void drainPool(void);
+static void endSlice(SLOT *);
+static JOB *takeJob(SLOT *);
+static int fillSlot(SLOT *);
+static long nextDeadline(void);
+static long sliceLength(JOB *);
+static long blockedFor(SLOT *);
+static void reapChildren(void);
+static void waitForEvent(long);
+static void logEvent(char *, JOB *);
 static void dispatcher(void);
+static void usage(char *);
 
 int main(int argc, char *argv[])
 {
+	static struct option longOptions[] =
+	{
+		{"quantum", required_argument, NULL, 'q'},
+		{"policy", required_argument, NULL, 'a'},
+		{"aging", required_argument, NULL, 'g'},
+		{"simulate", no_argument, NULL, 's'},
+		{"levels", required_argument, NULL, 'l'},
+		{"follow", required_argument, NULL, 'f'},
+		{"max-queued", required_argument, NULL, 'm'},
+		{"cpus", required_argument, NULL, 'c'},
+		{"pin", no_argument, NULL, 'p'},
+		{"pool", required_argument, NULL, 'P'},
+		{"channel", no_argument, NULL, 'C'},
+		{"report", required_argument, NULL, 'r'},
+		{"json", no_argument, NULL, 'j'},
+		{"latency", required_argument, NULL, 'L'},
+		{NULL, 0, NULL, 0}
+	};
+	int opt;
+
+	quantum = DEFAULT_QUANTUM;
+	policy = findPOLICY("mlfq");
+	aging = 0;
+	simulate = 0;
+	levels = DEFAULT_LEVELS;
+	maxQueued = 0;
+	cpus = 1;
+	poolSize = 0;
+	channel = 0;
+	reportPath = NULL;
+	reportJSON = 0;
+	latencyPath = NULL;
+	int pin = 0;
+	char *follow = NULL;
+
+	while ((opt = getopt_long(argc, argv, "q:a:g:sl:f:m:c:pP:Cr:jL:", longOptions, NULL)) != -1)
+	{
+		switch (opt)
+		{
+			case 'q':
+				quantum = atol(optarg);
+				if (quantum <= 0)
+				{
+					printf("Error: Quantum must be a positive number of milliseconds.\n");
+					exit(-1);
+				}
+				break;
+			case 'a':
+				if (!(policy = findPOLICY(optarg)))
+				{
+					printf("Error: Unknown policy %s.\n", optarg);
+					usage(argv[0]);
+				}
+				break;
+			case 'g':
+				aging = atol(optarg);
+				if (aging < 0)
+				{
+					printf("Error: Aging threshold cannot be negative.\n");
+					exit(-1);
+				}
+				break;
+			case 's':
+				simulate = 1;
+				break;
+			case 'l':
+				levels = atoi(optarg);
+				if (levels < 2 || levels > MLFQ_MAX_LEVELS)
+				{
+					printf("Error: Level count must be between 2 and %d.\n", MLFQ_MAX_LEVELS);
+					exit(-1);
+				}
+				break;
+			case 'f':
+				follow = optarg;
+				break;
+			case 'm':
+				maxQueued = atoi(optarg);
+				if (maxQueued < 0)
+				{
+					printf("Error: Queue limit cannot be negative.\n");
+					exit(-1);
+				}
+				break;
+			case 'c':
+				cpus = atoi(optarg);
+				if (cpus <= 0)
+				{
+					printf("Error: CPU count must be positive.\n");
+					exit(-1);
+				}
+				break;
+			case 'p':
+				pin = 1;
+				break;
+			case 'P':
+				poolSize = atoi(optarg);
+				if (poolSize < 0)
+				{
+					printf("Error: Pool size cannot be negative.\n");
+					exit(-1);
+				}
+				break;
+			case 'C':
+				channel = 1;
+				break;
+			case 'r':
+				reportPath = optarg;
+				break;
+			case 'j':
+				reportJSON = 1;
+				break;
+			case 'L':
+				latencyPath = optarg;
+				break;
+			default:
+				usage(argv[0]);
+		}
+	}
+
 	//printf("test\n");
-	if (argc < 2)
+	if (optind >= argc && !follow)
 	{
 		printf("Error: Not enough command line arguments.\n");
+		usage(argv[0]);
+	}
+	if (follow && simulate)
+	{
+		printf("Error: A job stream cannot be followed in virtual time.\n");
 		exit(-1);
 	}
 
-	/* Open input file for reading */
-	FILE *inputFile = fopen(argv[1], "r");
-
 	/* Set all vars to base values, initialize all queue data structs */
 	initialize();
-printf("initialized\n");
+
+	/* Slot i is pinned to core i, wrapping around the cores that are online */
+	int i;
+	long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	slots = calloc(cpus, sizeof(SLOT));
+	for (i = 0; i < cpus; i++)
+	{
+		slots[i].core = pin && !simulate ? i % cores : -1;
+		slots[i].ready = policy->create(levels, aging);
+	}
 	/* Read input file into job dispatch list */
-	readInFile(inputFile, jobList);
-	fclose(inputFile);
+	if (optind < argc)
+		readInFile(argv[optind]);
 
-	/* Send each job in job dispatch list to its proper priority queue */
-	dispatchJobs();
+	/* Jobs submitted while running are read between scheduling decisions */
+	if (follow && !(stream = newSTREAM(follow)))
+		exit(-1);
 
 	dispatcher();
 
+	if (simulate)
+		printf("%ld makespan\n", timer);
+	else
+		drainPool();
+	if (simulate || cpus > 1)
+		printf("%ld steals\n", steals);
+
+	if (metrics)
+		writeReport();
+	if (latencyPath)
+		writeLatency();
+
+	releaseSLAB(jobs);
+
 	//execvp("./process", args);
 
 	return 0;
@@ -103,22 +344,33 @@ printf("initialized\n");
 Required functions
 ************************/
 /**
- * Starts a process using the fork() command & returns the pid
+ * Starts a process for the job, handing it a stopped child from the pool
+ * when there is one and spawning a new one otherwise. Either way the child
+ * runs until it is terminated, so the job's time is counted only by the
+ * dispatcher, in milliseconds, and any quantum works.
  * @j - job to start
- * return the job
+ * return the job, or NULL if no process could be started
  */
 static JOB *startProcess(JOB *j)
 {
-	switch (j->pid = fork())
+	if (simulate)
+	{
+		j->pid = -1;
+		logEvent("start", j);
+		return j;
+	}
+
+	if (pooled > 0)
 	{
-		case -1:
-			return NULL;
-		case 0:
-			execvp(j->args[0], j->args);
-			return NULL;
-		default:
-			return j;
+		pooled -= 1;
+		j->pid = pool[pooled].pid;
+		j->control = pool[pooled].control;
+		return restartProcess(j) ? j : NULL;
 	}
+
+	if ((j->pid = spawnProcess(CHILD_LIFETIME, CONTROL_RUN, &j->control)) < 0)
+		return NULL;
+	return j;
 }
 
 /**
@@ -128,45 +380,72 @@ static JOB *startProcess(JOB *j)
  */
 static JOB *restartProcess(JOB *j)
 {
-	if (kill(j->pid, SIGCONT))
+	if (simulate)
+	{
+		logEvent("restart", j);
+		return j;
+	}
+
+	if (j->control)
+		sendCONTROL(j->control, CONTROL_RUN);
+	else if (j->pid <= 0 || kill(j->pid, SIGCONT))
 	{
 		printf("Error: Restart process error pid: %d\n", j->pid);
 		return NULL;
 	}
+	awaitChild(j, AWAIT_CONT);
 	return j;
 }
 
 /**
- * Terminates the process
+ * Terminates the process. The job is retired once the child has exited,
+ * which the dispatcher learns of between scheduling decisions.
  * @j - process or job to be terminated
  * return the process
  */
 static JOB *terminateProcess(JOB *j)
 {
-	if (kill(j->pid, SIGINT))
+	if (simulate)
+	{
+		logEvent("complete", j);
+		retire(j);
+		return j;
+	}
+
+	if (j->control)
+		sendCONTROL(j->control, CONTROL_EXIT);
+	else if (j->pid <= 0 || kill(j->pid, SIGINT))
 	{
 		printf("Error: Terminate process error pid: %d\n", j->pid);
 		return NULL;
 	}
-	int status;
-	waitpid(j->pid, &status, WUNTRACED);
+	awaitChild(j, AWAIT_EXIT);
 	return j;
 }
 
 /**
- * Suspends the process
+ * Suspends the process. The job rejoins a ready queue once the child has
+ * stopped, so it is never resumed before it has acknowledged the signal.
  * @j - the process or job to be suspended
  * return the process
  */
 static JOB *suspendProcess(JOB *j)
 {
-	if (kill(j->pid, SIGTSTP))
+	if (simulate)
+	{
+		logEvent("suspend", j);
+		stopped(j);
+		return j;
+	}
+
+	if (j->control)
+		sendCONTROL(j->control, CONTROL_PARK);
+	else if (j->pid <= 0 || kill(j->pid, SIGTSTP))
 	{
 		printf("Error: Suspend process error pid: %d\n", j->pid);
 		return NULL;
 	}
-	int status;
-	waitpid(j->pid, &status, WUNTRACED);
+	awaitChild(j, AWAIT_STOP);
 	return j;
 }
 
@@ -182,7 +461,38 @@ Utility functions
 static void displayJOB(FILE *fp, void *job)
 {
 	JOB *j = job;
-	fprintf(fp, "<%d>, <%d>, <%s>\n", j->arrivalTime, j->priority, j->processorTime);
+	fprintf(fp, "<%d>, <%d>, <%d>\n", j->arrivalTime, j->priority, j->processorTime);
+}
+
+/**
+ * Prints one line of the simulated schedule: time, action, job, priority and
+ * the CPU slot. Completions also report the job's turnaround time.
+ * @what - the scheduling action taken
+ * @j - the job acted on
+ */
+static void logEvent(char *what, JOB *j)
+{
+	if (j->remainingProcessorTime <= 0)
+		printf("%ld %s %d %d %d %ld\n", timer, what, j->id, j->priority, j->cpu, timer - j->arrivalTime * 1000L);
+	else
+		printf("%ld %s %d %d %d\n", timer, what, j->id, j->priority, j->cpu);
+}
+
+/**
+ * Prints the command line usage and exits
+ * @name - name the program was invoked as
+ */
+static void usage(char *name)
+{
+	printf("Usage: %s [-q|--quantum ms] [-a|--policy ", name);
+	listPOLICY(stdout);
+	printf("]\n"
+		"       [-g|--aging ms] [-s|--simulate] [-l|--levels n]\n"
+		"       [-f|--follow -|fifo|file] [-m|--max-queued n]\n"
+		"       [-c|--cpus n] [-p|--pin] [-P|--pool n] [-C|--channel]\n"
+		"       [-r|--report -|file [-j|--json]] [-L|--latency -|file]\n"
+		"       [job file]\n");
+	exit(-1);
 }
 
 /**
@@ -190,15 +500,74 @@ static void displayJOB(FILE *fp, void *job)
  */
 static void initialize(void)
 {
-	running = NULL;
+	busy = 0;
+	steals = 0;
 	timer = 0;
+	jobCount = 0;
+	jobs = newSLAB(sizeof(JOB), JOBS_PER_SLAB);
+	stream = NULL;
+	streamWatched = 0;
 
 	/* Initialize all queues */
-	jobList 	= newQUEUE(displayJOB);
-	sysQueue 	= newQUEUE(displayJOB);
-	p1q 		= newQUEUE(displayJOB);
-	p2q 		= newQUEUE(displayJOB);
-	p3q 		= newQUEUE(displayJOB);
+	jobList 	= newHEAP(displayJOB, compareArrival);
+	signalled	= newCDA(displayJOB);
+	metrics		= reportPath ? newMETRICS(levels) : NULL;
+	suspendLatency = newHISTOGRAM();
+	restartLatency = newHISTOGRAM();
+	terminateLatency = newHISTOGRAM();
+	decisionLatency = newHISTOGRAM();
+
+	if (simulate)
+	{
+		/* Virtual time: the schedule is written out in one buffered stream */
+		setvbuf(stdout, NULL, _IOFBF, 1 << 16);
+		return;
+	}
+
+	/* Child state changes are read from a signalfd instead of a handler */
+	sigset_t mask;
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGCHLD);
+	sigprocmask(SIG_BLOCK, &mask, &origMask);
+	childfd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+
+	events = newEVENTS();
+	watchEVENTS(events, childfd, EVENT_CHILD);
+
+	/* kill -USR1 writes the reports so far without stopping the dispatcher */
+	if (metrics || latencyPath)
+	{
+		sigset_t usr1;
+		sigemptyset(&usr1);
+		sigaddset(&usr1, SIGUSR1);
+		sigprocmask(SIG_BLOCK, &usr1, NULL);
+		reportfd = signalfd(-1, &usr1, SFD_NONBLOCK | SFD_CLOEXEC);
+		watchEVENTS(events, reportfd, EVENT_REPORT);
+	}
+
+	/* Children start with the signal mask the dispatcher was started with */
+	posix_spawnattr_init(&spawnAttr);
+	posix_spawnattr_setsigmask(&spawnAttr, &origMask);
+	posix_spawnattr_setflags(&spawnAttr, POSIX_SPAWN_SETSIGMASK);
+
+	/* Children with a channel get it at CONTROL_FD and say so in their environment */
+	if (channel)
+	{
+		int n = 0;
+		while (environ[n])
+			n++;
+		channelEnv = malloc(sizeof(char *) * (n + 2));
+		memcpy(channelEnv, environ, sizeof(char *) * n);
+		channelEnv[n] = CONTROL_ENV "=1";
+		channelEnv[n + 1] = NULL;
+
+		notifyfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		watchEVENTS(events, notifyfd, EVENT_CONTROL);
+	}
+
+	pooled = 0;
+	pool = malloc(sizeof(CHILD) * (poolSize > 0 ? poolSize : 1));
+	fillPool();
 }
 
 /**
@@ -207,258 +576,770 @@ static void initialize(void)
  */
 static int complete(void)
 {
-	if (running || !priorityQueuesEmpty() || sizeQUEUE(sysQueue) > 0 || sizeQUEUE(jobList) > 0)
+	if (busy > 0 || sizeCDA(signalled) > 0 || readyJobs() > 0 || sizeHEAP(jobList) > 0 || (stream && openSTREAM(stream)))
 		return 0;
 	else
 		return 1;
 }
 
 /**
- * Checks the priority queues to see if they are empty
- * @q1 - first queue
- * @q2 - second queue
- * @q3 - third queue
- * return 1 if all queues empty, 0 if at least one job in at least one queue
+ * Loads the job file and places each job in the dispatch list
+ * @path - job file to be read from
  */
-static int priorityQueuesEmpty(void) {
-	if (sizeQUEUE(p1q) == 0 && sizeQUEUE(p2q) == 0 && sizeQUEUE(p3q) == 0)
+static void readInFile(char *path)
+{
+	if (loadJOBFILE(path, admitJOB) < 0)
+		exit(-1);
+}
+
+/**
+ * Returns how many jobs are waiting, either to arrive or to run
+ */
+static int queued(void)
+{
+	return readyJobs() + sizeHEAP(jobList);
+}
+
+/**
+ * Copies a parsed job record into a new job on the dispatch list
+ * @record - parsed job record, only valid during the call
+ */
+static void admitJOB(JOB *record)
+{
+	JOB *j = allocSLAB(jobs);
+
+	*j = *record;
+	j->id = ++jobCount;
+	insertHEAP(jobList, j);
+
+	if (metrics)
+		arriveMETRICS(metrics, j->id, j->priority, j->arrivalTime * 1000L,
+			j->deadline ? (j->arrivalTime + (long) j->deadline) * 1000L : -1);
+}
+
+/**
+ * Admits a record read from the job stream. A job cannot arrive before it
+ * was submitted, so an arrival time already past counts from now.
+ * @record - parsed job record, only valid during the call
+ */
+static void admitStreamed(JOB *record)
+{
+	if (record->arrivalTime < timer / 1000)
+		record->arrivalTime = timer / 1000;
+	admitJOB(record);
+}
+
+/**
+ * Gives a finished job's storage back for reuse by later jobs
+ * @j - the job that has completed
+ */
+static void retire(JOB *j)
+{
+	if (policy->complete && j->cpu >= 0)
+		policy->complete(slots[j->cpu].ready, j);
+	if (j->control)
+		freeCONTROL(j->control);
+	freeSLAB(jobs, j);
+}
+
+/**
+ * Hands a job whose process has stopped back to the policy, on the slot
+ * it ran in
+ * @j - the suspended job
+ */
+static void stopped(JOB *j)
+{
+	j->queuedAt = timer;
+	policy->preempt(slots[j->cpu].ready, j);
+}
+
+/**
+ * Records that a job's child has been signalled, to be matched with the
+ * child's acknowledgement when it arrives. A newer signal replaces one
+ * still unanswered.
+ * @j - the signalled job
+ * @what - AWAIT_STOP, AWAIT_CONT or AWAIT_EXIT
+ */
+static void awaitChild(JOB *j, int what)
+{
+	if (j->awaiting == AWAIT_NONE)
+		insertCDAback(signalled, j);
+	j->awaiting = what;
+	j->signalledAt = nowNS();
+}
+
+/**
+ * Reads any jobs waiting on the stream without blocking. Above the queue
+ * limit the stream is left unread and unwatched, so its writer blocks
+ * until the dispatcher catches up.
+ */
+static void ingest(void)
+{
+	if (!stream || !openSTREAM(stream))
+		return;
+
+	int budget = maxQueued > 0 ? maxQueued - queued() : INT_MAX;
+	if (budget > 0)
+		readSTREAM(stream, admitStreamed, budget);
+
+	int watch = openSTREAM(stream) && (maxQueued == 0 || queued() < maxQueued);
+	if (watch && !streamWatched)
+		watchEVENTS(events, fdSTREAM(stream), EVENT_STREAM);
+	else if (!watch && streamWatched && openSTREAM(stream))
+		unwatchEVENTS(events, fdSTREAM(stream));
+	streamWatched = watch;
+}
+
+/**
+ * Orders jobs by arrival time, keeping input order among jobs that arrive together
+ * @a - first job
+ * @b - second job
+ * return negative if a arrives first, positive if b does
+ */
+static int compareArrival(void *a, void *b)
+{
+	JOB *x = a;
+	JOB *y = b;
+
+	if (x->arrivalTime != y->arrivalTime)
+		return x->arrivalTime < y->arrivalTime ? -1 : 1;
+	return x->id - y->id;
+}
+
+/**
+ * Takes every job that has arrived by now off the job dispatch list and sends
+ * it to its priority queue. Jobs that have not arrived yet are never looked at.
+ * A job whose deadline the policy cannot promise runs without one.
+ */
+static void admitArrivals(void)
+{
+	while (sizeHEAP(jobList) > 0 && ((JOB *) peekHEAP(jobList))->arrivalTime * 1000L <= timer)
 	{
-		return 1;
+		JOB *j = extractHEAP(jobList);
+		SLOT *s = leastLoaded();
+
+		if (j->deadline && policy->admit && !policy->admit(s->ready, j, timer, blockedFor(s)))
+		{
+			if (simulate)
+				logEvent("reject", j);
+			if (metrics)
+				rejectMETRICS(metrics, j->id);
+			j->deadline = 0;
+		}
+
+		j->queuedAt = timer;
+		policy->arrive(s->ready, j);
 	}
-	else
+}
+
+/**
+ * Returns how long until a slot's running job gives up the CPU: a system
+ * job keeps it until it finishes, any other job until its slice ends
+ * @s - the slot
+ */
+static long blockedFor(SLOT *s)
+{
+	JOB *running = s->running;
+
+	if (!running)
 		return 0;
+	if (running->priority == 0)
+		return running->remainingProcessorTime - (timer - s->sliceStart);
+	return s->sliceEnd - timer;
 }
 
 /**
- * Incremements the priority of the given job
- * @j - job of which priority is to be incremented
+ * Returns the time the next job arrives at, or -1 if every job has arrived
  */
-static void incrementPriority(JOB *j)
+static long nextArrival(void)
 {
-	if (j->priority < 3) j->priority += 1;
+	if (sizeHEAP(jobList) == 0)
+		return -1;
+	return ((JOB *) peekHEAP(jobList))->arrivalTime * 1000L;
 }
 
 /**
- * Reads the input file and places each job in the dispatch list as an object
- * @fp - file to be read from
- * @q - queue to which job objects are enqueued
+ * Returns the slot with the least work, counting its running job, which is
+ * where a newly arrived job is placed
  */
-static void readInFile(FILE *fp, QUEUE *q)
+static SLOT *leastLoaded(void)
 {
-	char *str = readToken(fp);
+	SLOT *best = &slots[0];
+	int bestLoad = policy->size(best->ready) + (best->running != NULL);
 
-	while (str)
+	int i;
+	for (i = 1; i < cpus && bestLoad > 0; i++)
 	{
-		int arrivalTime = atoi(str);
-		int priority = atoi(readToken(fp));
-		char *processorTime = readToken(fp);
+		int load = policy->size(slots[i].ready) + (slots[i].running != NULL);
+		if (load < bestLoad)
+		{
+			best = &slots[i];
+			bestLoad = load;
+		}
+	}
 
-		/* Create new JOB object and fill it with attribute data */
-		JOB *job = malloc(sizeof(struct JOB));
+	return best;
+}
 
-		job->arrivalTime = arrivalTime;
-		job->priority = priority;
-		job->processorTime = processorTime;
-		job->remainingProcessorTime = atoi(processorTime);
-		job->args[0] = "./process";
-		job->args[1] = processorTime;
-		job->args[2] = NULL;
+/**
+ * Returns the number of jobs waiting in every slot's queues
+ */
+static int readyJobs(void)
+{
+	int n = 0;
 
-		/* Add the new object to the job dispatch list queue */
-		enqueue(q, job);
+	int i;
+	for (i = 0; i < cpus; i++)
+		n += policy->size(slots[i].ready);
 
-		str = readToken(fp);
-	}
+	return n;
 }
 
 /**
- * Takes jobs from job dispatch list queue and sends them to their appropriate priority queue
- * @jobList - job dispatch list
- * @p1q - Priority queue 1
- * @p2q - Priority queue 2
- * @p3q - Priority queue 3
+ * Returns the length of the next time slice for the job, which is the
+ * quantum unless the job needs less than that to finish
+ * @j - the job about to run
  */
-static void dispatchJobs(void)
+static long sliceLength(JOB *j)
 {
-	JOB *currJob = dequeue(jobList);
+	return j->remainingProcessorTime < quantum ? j->remainingProcessorTime : quantum;
+}
 
-	while (sizeQUEUE(jobList) >= 0)
+/**
+ * Drains pending SIGCHLD notifications and collects every child state
+ * change: signalled children acknowledging a stop or exit, and children
+ * that exited on their own, so a job that finishes before its slice ends
+ * frees the CPU
+ */
+static void reapChildren(void)
+{
+	struct signalfd_siginfo info;
+	while (read(childfd, &info, sizeof(info)) == sizeof(info))
+		;
+
+	int status;
+	pid_t pid;
+	while ((pid = waitpid(-1, &status, WNOHANG | WUNTRACED | WCONTINUED)) > 0)
 	{
-		switch (currJob->priority)
+		int i;
+		for (i = 0; i < sizeCDA(signalled); i++)
 		{
-			case (0):
-				enqueue(sysQueue, currJob);
-				break;
-			case (1):
-				enqueue(p1q, currJob);
-				break;
-			case (2):
-				enqueue(p2q, currJob);
-				break;
-			case (3):
-				enqueue(p3q, currJob);
-				break;
-			default:
-				enqueue(sysQueue, currJob);		// FIXME: might need to default to something else
+			JOB *j = getCDA(signalled, i);
+			if (j->pid != pid)
+				continue;
+
+			/* A stop or continue other than the one awaited is not an answer */
+			int what = j->awaiting;
+			if ((WIFSTOPPED(status) && what != AWAIT_STOP) || (WIFCONTINUED(status) && what != AWAIT_CONT))
 				break;
-		}
 
-		if (sizeQUEUE(jobList) == 0)
+			dropSignalled(i);
+
+			if (WIFSTOPPED(status))
+			{
+				recordHISTOGRAM(suspendLatency, nowNS() - j->signalledAt);
+				stopped(j);
+			}
+			else if (WIFCONTINUED(status))
+				recordHISTOGRAM(restartLatency, nowNS() - j->signalledAt);
+			else if (what != AWAIT_CONT)
+			{
+				/* Still running jobs that exit are retired with their slot below */
+				if (what == AWAIT_EXIT)
+					recordHISTOGRAM(terminateLatency, nowNS() - j->signalledAt);
+				else if (metrics)
+					completeMETRICS(metrics, j->id, timer);
+				j->remainingProcessorTime = 0;
+				retire(j);
+			}
 			break;
+		}
+
+		if (WIFSTOPPED(status) || WIFCONTINUED(status))
+			continue;
 
-		if (peekQUEUE(jobList))
-			currJob = dequeue(jobList);
+		for (i = 0; i < pooled; i++)
+		{
+			if (pool[i].pid == pid)
+			{
+				if (pool[i].control)
+					freeCONTROL(pool[i].control);
+				pool[i--] = pool[--pooled];
+			}
+		}
+
+		for (i = 0; i < cpus; i++)
+		{
+			if (slots[i].running && slots[i].running->pid == pid)
+			{
+				if (metrics)
+					completeMETRICS(metrics, slots[i].running->id, timer);
+				slots[i].running->remainingProcessorTime = 0;
+				retire(slots[i].running);
+				slots[i].running = NULL;
+				busy -= 1;
+			}
+		}
 	}
 }
 
 /**
- * Enqueues the job to the correct priority queue
- * @j - the job to be enqueued
+ * Blocks until the deadline passes, a child changes state or the job stream
+ * has more to read (which the next pass of the dispatcher picks up). When
+ * simulating, the virtual clock jumps straight to the deadline instead.
+ * @deadline - time to wake up at, or -1 to wait for a child only
  */
-static void enqToPriority(JOB *j)		// FIXME: the priorities might be reversed
+static void waitForEvent(long deadline)
 {
-	switch (j->priority)
+	int tags[8];
+	int n;
+
+	if (simulate)
 	{
-		case 1:
-			enqueue(sysQueue, j);
-			break;
-		case 2:
-			enqueue(p1q, j);
-			break;
-		case 3:
-			enqueue(p2q, j);
-			break;
+		if (deadline > timer)
+			timer = deadline;
+		return;
+	}
+
+	armEVENTS(events, deadline);
+	n = waitEVENTS(events, tags, 8);
+	timer = nowEVENTS(events);
+
+	int i;
+	for (i = 0; i < n; i++)
+	{
+		if (tags[i] == EVENT_CHILD)
+			reapChildren();
+		else if (tags[i] == EVENT_CONTROL)
+			collectAcknowledged();
+		else if (tags[i] == EVENT_REPORT)
+		{
+			struct signalfd_siginfo info;
+			while (read(reportfd, &info, sizeof(info)) == sizeof(info))
+				;
+			if (metrics)
+				writeReport();
+			if (latencyPath)
+				writeLatency();
+		}
 	}
 }
 
 /**
- * Send job to proper queue
- * @j - job to be sent
+ * Writes the per-job and per-queue report to the report path
  */
-static void sendToQueue(JOB *j)
+static void writeReport(void)
 {
-	switch (j->priority)
+	FILE *fp = strcmp(reportPath, "-") ? fopen(reportPath, "w") : stdout;
+	if (!fp)
 	{
-		case 0:
-			enqueue(sysQueue, j);
-			break;
-		case 1:
-			enqueue(p1q, j);
-			break;
-		case 2:
-			enqueue(p2q, j);
-			break;
-		case 3:
-			enqueue(p3q, j);
-			break;
-		default:
+		perror(reportPath);
+		return;
+	}
+
+	if (policy->shares)
+	{
+		double *target = calloc(levels, sizeof(double));
+		double *achieved = calloc(levels, sizeof(double));
+		int i;
+		for (i = 0; i < cpus; i++)
+			policy->shares(slots[i].ready, target, achieved);
+		sharesMETRICS(metrics, target, achieved);
+		free(target);
+		free(achieved);
+	}
+
+	reportMETRICS(fp, metrics, reportJSON);
+
+	if (fp != stdout)
+		fclose(fp);
+}
+
+/**
+ * Drains the channel notifications and settles every job whose child has
+ * answered: parked ones are requeued, resumed ones need nothing more
+ */
+static void collectAcknowledged(void)
+{
+	uint64_t count;
+	while (read(notifyfd, &count, sizeof(count)) == sizeof(count))
+		;
+
+	int i;
+	for (i = 0; i < sizeCDA(signalled); i++)
+	{
+		JOB *j = getCDA(signalled, i);
+		if (j->awaiting == AWAIT_EXIT || !j->control || !ackedCONTROL(j->control))
+			continue;
+
+		int what = j->awaiting;
+		dropSignalled(i--);
+		if (what == AWAIT_STOP)
+		{
+			recordHISTOGRAM(suspendLatency, nowNS() - j->signalledAt);
+			stopped(j);
+		}
+		else
+			recordHISTOGRAM(restartLatency, nowNS() - j->signalledAt);
+	}
+}
+
+/**
+ * Removes a job from the signalled list, swapping the last entry into its
+ * place since the order does not matter
+ * @i - index of the job in the list
+ */
+static void dropSignalled(int i)
+{
+	JOB *j = getCDA(signalled, i);
+
+	setCDA(signalled, i, getCDA(signalled, sizeCDA(signalled) - 1));
+	removeCDAback(signalled);
+	j->awaiting = AWAIT_NONE;
+}
+
+/**
+ * Returns the monotonic clock in nanoseconds, for timing round trips
+ */
+static long nowNS(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+/**
+ * Writes count, mean and percentiles of each kind of round trip and of
+ * the scheduling decisions themselves, in microseconds, to the latency path
+ */
+static void writeLatency(void)
+{
+	char *names[] = { "suspend", "restart", "terminate", "decide" };
+	HISTOGRAM *histograms[] = { suspendLatency, restartLatency, terminateLatency, decisionLatency };
+
+	FILE *fp = strcmp(latencyPath, "-") ? fopen(latencyPath, "w") : stdout;
+	if (!fp)
+	{
+		perror(latencyPath);
+		return;
+	}
+
+	fprintf(fp, "%-10s %10s %10s %10s %10s %10s %10s %10s\n",
+		"op", "count", "min_us", "mean_us", "p50_us", "p99_us", "p999_us", "max_us");
+
+	int i;
+	for (i = 0; i < 4; i++)
+	{
+		HISTOGRAM *h = histograms[i];
+		fprintf(fp, "%-10s %10ld %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n", names[i], countHISTOGRAM(h),
+			minHISTOGRAM(h) / 1000.0, meanHISTOGRAM(h) / 1000.0,
+			percentileHISTOGRAM(h, 50) / 1000.0, percentileHISTOGRAM(h, 99) / 1000.0,
+			percentileHISTOGRAM(h, 99.9) / 1000.0, maxHISTOGRAM(h) / 1000.0);
+	}
+
+	if (fp != stdout)
+		fclose(fp);
+	else
+		fflush(fp);
+}
+
+/**
+ * Moves a process onto the core of the slot it is about to run in
+ * @j - the job whose process is moved
+ * @core - the core to pin it to, or -1 to leave it unpinned
+ */
+static void pinProcess(JOB *j, int core)
+{
+	if (core < 0 || simulate || j->pid <= 0)
+		return;
+
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(core, &set);
+	sched_setaffinity(j->pid, sizeof(set), &set);
+}
+
+/**
+ * Spawns ./process without copying the dispatcher's address space. With
+ * --channel the child is given a control channel, falling back to signals
+ * if one cannot be made.
+ * @lifetime - seconds the process runs for if never terminated
+ * @command - what the channel first tells the child to do
+ * @control - set to the child's channel, or NULL for signals
+ * return the child's pid, or -1 if it could not be spawned
+ */
+static pid_t spawnProcess(char *lifetime, int command, CONTROL **control)
+{
+	char *args[] = { "./process", lifetime, NULL };
+	posix_spawn_file_actions_t actions;
+	pid_t pid;
+	int fd;
+
+	*control = channel ? newCONTROL(command, &fd) : NULL;
+
+	posix_spawn_file_actions_init(&actions);
+	if (*control)
+	{
+		posix_spawn_file_actions_adddup2(&actions, fd, CONTROL_FD);
+		posix_spawn_file_actions_adddup2(&actions, notifyfd, CONTROL_NOTIFY_FD);
+	}
+
+	int err = posix_spawn(&pid, args[0], &actions, &spawnAttr, args, *control ? channelEnv : environ);
+	posix_spawn_file_actions_destroy(&actions);
+
+	if (*control)
+		close(fd);
+	if (err)
+	{
+		printf("Error: Could not start %s: %s\n", args[0], strerror(err));
+		if (*control)
+			freeCONTROL(*control);
+		*control = NULL;
+		return -1;
+	}
+	return pid;
+}
+
+/**
+ * Tops the pool up with stopped or parked children, so starting a job
+ * costs a SIGCONT or a channel command. Called while the dispatcher would
+ * otherwise be waiting.
+ */
+static void fillPool(void)
+{
+	while (pooled < poolSize)
+	{
+		CONTROL *control;
+		pid_t pid = spawnProcess(CHILD_LIFETIME, CONTROL_PARK, &control);
+		if (pid < 0)
+			return;
+
+		/* Wait for the stop so it is not mistaken for a later suspension */
+		int status;
+		if (!control)
+		{
+			kill(pid, SIGSTOP);
+			if (waitpid(pid, &status, WUNTRACED) != pid || !WIFSTOPPED(status))
+			{
+				printf("Error: Pooled process %d exited before it stopped\n", pid);
+				poolSize = pooled;
+				return;
+			}
+		}
+
+		pool[pooled].pid = pid;
+		pool[pooled].control = control;
+		pooled += 1;
+	}
+}
+
+/**
+ * Ends the children still waiting in the pool
+ */
+static void drainPool(void)
+{
+	int status;
+
+	while (pooled > 0)
+	{
+		pooled -= 1;
+		kill(pool[pooled].pid, SIGKILL);
+		waitpid(pool[pooled].pid, &status, 0);
+		if (pool[pooled].control)
+			freeCONTROL(pool[pooled].control);
+	}
+}
+
+/**
+ * Handles the end of a slot's time slice: the job finishes, is preempted
+ * in favour of a waiting job, or keeps the CPU for another slice
+ * @s - the slot whose slice is over
+ */
+static void endSlice(SLOT *s)
+{
+	JOB *running = s->running;
+
+	running->remainingProcessorTime -= s->sliceEnd - s->sliceStart;
+
+	if (running->remainingProcessorTime <= 0)
+	{
+		if (metrics)
+			completeMETRICS(metrics, running->id, timer);
+		terminateProcess(running);
+		running = NULL;
+	}
+	else if (policy->tick(s->ready, running))
+	{
+		if (metrics)
+			suspendMETRICS(metrics, running->id, timer);
+		suspendProcess(running);
+		running = NULL;
+	}
+
+	/* Nothing else to run, so the job keeps the CPU for another slice */
+	if (running)
+	{
+		s->sliceStart = timer;
+		s->sliceEnd = timer + sliceLength(running);
+	}
+	else
+	{
+		s->running = NULL;
+		busy -= 1;
+	}
+}
+
+/**
+ * Takes the next job for a slot from its own ready jobs or, if it has none,
+ * steals one from the slot with the most waiting
+ * @s - the idle slot
+ * return the job, or NULL if no slot has one waiting
+ */
+static JOB *takeJob(SLOT *s)
+{
+	JOB *j = policy->pick(s->ready);
+	if (j)
+		return j;
+
+	SLOT *victim = NULL;
+
+	int i;
+	for (i = 0; i < cpus; i++)
+	{
+		if (policy->size(slots[i].ready) > 0 && (!victim || policy->size(slots[i].ready) > policy->size(victim->ready)))
+			victim = &slots[i];
+	}
+
+	if (!victim)
+		return NULL;
+
+	steals += 1;
+	return policy->steal ? policy->steal(victim->ready) : policy->pick(victim->ready);
+}
+
+/**
+ * Starts or resumes the highest priority ready job on an idle slot. A slot
+ * with nothing of its own to run steals from the slot with the most waiting.
+ * A job whose process cannot be started or resumed is dropped.
+ * @s - the idle slot
+ * return 1 if the slot now has a running job, 0 if there was nothing to run
+ */
+static int fillSlot(SLOT *s)
+{
+	JOB *running;
+
+	while ((running = takeJob(s)) != NULL)
+	{
+		running->cpu = s - slots;
+
+		if (running->pid != 0)
+		{
+			pinProcess(running, s->core);
+			if (restartProcess(running))
+				break;
+		}
+		else if (startProcess(running))
+		{
+			pinProcess(running, s->core);
 			break;
+		}
+
+		/* Its process could not be started or resumed, so it can never run */
+		printf("Error: Job %d could not be run and is dropped\n", running->id);
+		retire(running);
 	}
 
-	return;
+	if (!running)
+		return 0;
+
+	if (metrics)
+		runMETRICS(metrics, running->id, timer);
+
+	s->running = running;
+	s->sliceStart = timer;
+	s->sliceEnd = timer + sliceLength(running);
+	busy += 1;
+
+	return 1;
 }
 
 /**
- * Returns the highest priority queue that is not null or sysQueue
- * return - highest priority non-null queue
+ * Returns when the dispatcher next has a decision to make: the earliest end
+ * of a running slice or, while some slot is idle, the next arrival
  */
-static QUEUE *getHighestPriorityQ(void)
+static long nextDeadline(void)
 {
-	if (sizeQUEUE(p1q) > 0)
-		return p1q;
-	else if (sizeQUEUE(p2q) > 0)
-		return p2q;
-	else if (sizeQUEUE(p3q) > 0)
-		return p3q;
+	long deadline = busy < cpus ? nextArrival() : -1;
 
-	return NULL;
+	int i;
+	for (i = 0; i < cpus; i++)
+	{
+		if (slots[i].running && (deadline < 0 || slots[i].sliceEnd < deadline))
+			deadline = slots[i].sliceEnd;
+	}
+
+	return deadline;
 }
 
 static void dispatcher(void)
 {
 	// while (still things in any queues)
-	//		1. enqueue to appropriate queues
-	//		2. if (--remainingProcessorTime of process is 0)
-	//			a. terminate the process
-	//		   else if (there's another process waiting in any queue)
-	//			if (priority is not 0)
+	//		1. enqueue jobs that have arrived to appropriate queues
+	//		2. for each slot whose running job's slice is over
+	//			if (its remainingProcessorTime is used up)
+	//				a. terminate the process
+	//			else if (the policy preempts it, e.g. mlfq: another process waits and priority is not 0)
 	//				a. suspend the process
-	//				b. increment its priority (as long as not greater than 3 result)
-	//		3. if process is not current running process but still in queues
-	//			if (in sysqueue)
-	//				set running to dequeue of sysqueue
-	//			else
-	//				set to one of the other queues
+	//				b. once it has stopped, hand it back to the policy (mlfq demotes and requeues it)
+	//		3. for each idle slot, while there are still processes in any slot's queues
+	//			set its running job to the one its policy picks,
+	//			or steal from the busiest slot's if its own are empty
 	//		   if processs has been suspended (running->pid != 0)
 	//				restart the running process
 	//		   else
 	//				start new process
 	//				print status of process
-	//		4. sleep, increment timer
+	//		4. top up the pool of stopped children
+	//		5. block until a slice ends, the next job arrives for an idle slot or a child changes state, update timer
+
+	int i;
 
 	while (!complete())
 	{
-/*
-		JOB *next = dequeue(jobList);
-		printf("flag\n");
-		while (sizeQUEUE(jobList) > 0)
-		{
-			printf("flag2\n");
-			if (next->arrivalTime <= timer)
-			{
-				// enqueue next to the appropriate queue
-				sendToQueue(next);
-			}
+		if (!simulate)
+			timer = nowEVENTS(events);
+		ingest();
 
-			next = dequeue(jobList);
-		}
-*/
-		if (running)
+		long decided = latencyPath ? nowNS() : 0;
+		admitArrivals();
+
+		if (policy->age)
 		{
-			if (--running->remainingProcessorTime == 0)
-			{
-				terminateProcess(running);
-				running = NULL;
-			}
-			else if (!priorityQueuesEmpty() || sizeQUEUE(sysQueue) > 0)				// FIXME: Might need to be another condition in the elif statement
-			{
-				if (running->priority != 0)
-				{
-					JOB *j = suspendProcess(running);
-					incrementPriority(j);
-					enqToPriority(j);
-					running = NULL;
-				}
-			}
+			for (i = 0; i < cpus; i++)
+				policy->age(slots[i].ready, timer);
 		}
 
-		if (!running && (!priorityQueuesEmpty() || sizeQUEUE(sysQueue) > 0))
+		for (i = 0; i < cpus; i++)
 		{
-			//printf("no running processes, setting running to ...\n");
-			if (sizeQUEUE(sysQueue) > 0)
-			{
-			//	printf("running is a system process\n");
-				running = dequeue(sysQueue);
-			}
-			else if (!priorityQueuesEmpty())
-			{
-			//	printf("running is a priority queue process\n");
-				running = dequeue(getHighestPriorityQ());
-			}
+			if (slots[i].running && timer >= slots[i].sliceEnd)
+				endSlice(&slots[i]);
+		}
 
-			if (running->pid != 0)
-			{
-				restartProcess(running);
-			}
-			else
-			{
-				startProcess(running);
-				//print the process... needed???
-			}
+		for (i = 0; i < cpus && busy < cpus; i++)
+		{
+			if (!slots[i].running && !fillSlot(&slots[i]))
+				break;
 		}
 
-		sleep(1);
-		++timer;
+		if (latencyPath)
+			recordHISTOGRAM(decisionLatency, nowNS() - decided);
+
+		if (!complete())
+		{
+			if (!simulate)
+				fillPool();
+			waitForEvent(nextDeadline());
+		}
 	}
 /*
 	char *args[3];
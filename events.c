@@ -0,0 +1,115 @@
+/*This file serves as method implementations for the
+ *event loop object. All times are milliseconds on the
+ *monotonic clock, measured from the creation of the loop.
+ *A single one-shot timerfd carries the next deadline and
+ *every other source is an fd registered with epoll under a tag.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include "events.h"
+
+struct events {
+  int epfd;
+  int timerfd;
+  struct timespec origin;
+};
+
+static void toTimespec(EVENTS *ev, long ms, struct timespec *ts) {
+  ts->tv_sec = ev->origin.tv_sec + ms / 1000;
+  ts->tv_nsec = ev->origin.tv_nsec + (ms % 1000) * 1000000L;
+  if (ts->tv_nsec >= 1000000000L) {
+    ts->tv_sec += 1;
+    ts->tv_nsec -= 1000000000L;
+  }
+}
+
+EVENTS *newEVENTS(void) {
+  assert( sizeof(EVENTS) != 0 );
+
+  EVENTS *ev = malloc( sizeof(EVENTS) );
+  assert(ev != 0);
+
+  ev->epfd = epoll_create1(EPOLL_CLOEXEC);
+  ev->timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (ev->epfd < 0 || ev->timerfd < 0) {
+    perror("Error: event loop");
+    exit(-1);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &ev->origin);
+
+  watchEVENTS(ev, ev->timerfd, EVENT_TIMER);
+
+  return ev;
+}
+
+long nowEVENTS(EVENTS *ev) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return (now.tv_sec - ev->origin.tv_sec) * 1000L
+       + (now.tv_nsec - ev->origin.tv_nsec) / 1000000L;
+}
+
+/*
+ *Arms the timer for an absolute deadline; a negative deadline disarms it
+ *so that only fd activity can end the next wait.
+ */
+void armEVENTS(EVENTS *ev, long deadline) {
+  struct itimerspec spec = { { 0, 0 }, { 0, 0 } };
+
+  if (deadline >= 0) {
+    toTimespec(ev, deadline, &spec.it_value);
+    /* a zero it_value would disarm, so a deadline at the origin fires at 1ns */
+    if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0) { spec.it_value.tv_nsec = 1; }
+  }
+
+  timerfd_settime(ev->timerfd, TFD_TIMER_ABSTIME, &spec, NULL);
+}
+
+int watchEVENTS(EVENTS *ev, int fd, int tag) {
+  struct epoll_event e;
+  e.events = EPOLLIN;
+  e.data.u64 = ((unsigned long long) (unsigned) tag << 32) | (unsigned) fd;
+
+  return epoll_ctl(ev->epfd, EPOLL_CTL_ADD, fd, &e);
+}
+
+void unwatchEVENTS(EVENTS *ev, int fd) {
+  epoll_ctl(ev->epfd, EPOLL_CTL_DEL, fd, NULL);
+}
+
+/*
+ *Blocks until at least one source is ready and stores the tag of each
+ *ready source in tags. Timer expirations are consumed here; reading the
+ *other fds is left to the caller. Returns the number of tags stored.
+ */
+int waitEVENTS(EVENTS *ev, int *tags, int max) {
+  struct epoll_event ready[16];
+  int n;
+
+  if (max > 16) { max = 16; }
+
+  do {
+    n = epoll_wait(ev->epfd, ready, max, -1);
+  } while (n < 0 && errno == EINTR);
+
+  int i;
+  for (i = 0; i < n; i++) {
+    int fd = (int) (ready[i].data.u64 & 0xffffffffu);
+    tags[i] = (int) (ready[i].data.u64 >> 32);
+
+    if (fd == ev->timerfd) {
+      unsigned long long expirations;
+      if (read(fd, &expirations, sizeof(expirations)) < 0) { tags[i] = -1; }
+    }
+  }
+
+  return n < 0 ? 0 : n;
+}
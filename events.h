@@ -0,0 +1,18 @@
+/*This file serves as the header for the events.c file
+ */
+
+#ifndef __EVENTS_INCLUDED__
+#define __EVENTS_INCLUDED__
+
+#define EVENT_TIMER 0
+
+typedef struct events EVENTS;
+
+extern EVENTS *newEVENTS(void);
+extern long nowEVENTS(EVENTS *ev);
+extern void armEVENTS(EVENTS *ev,long deadline);
+extern int watchEVENTS(EVENTS *ev,int fd,int tag);
+extern void unwatchEVENTS(EVENTS *ev,int fd);
+extern int waitEVENTS(EVENTS *ev,int *tags,int max);
+
+#endif
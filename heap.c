@@ -0,0 +1,101 @@
+/*This file serves as method implementations for the
+ *binary min-heap object. The comparator returns a negative
+ *number when its first argument belongs closer to the top.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <stdlib.h>
+#include "heap.h"
+
+struct heap {
+  void (*display)(FILE *, void *);
+  int (*compare)(void *, void *);
+  int size;
+  int filledIndices;
+  void **array;
+};
+
+static void swap(void **array, int a, int b) {
+  void *tmp = array[a];
+  array[a] = array[b];
+  array[b] = tmp;
+}
+
+HEAP *newHEAP(void (*d)(FILE *, void *), int (*c)(void *, void *)) {
+  assert( sizeof(HEAP) != 0 );
+
+  HEAP *h = malloc( sizeof(HEAP) );
+  assert(h != 0);
+
+  h->display = d;
+  h->compare = c;
+  h->size = 16;
+  h->filledIndices = 0;
+  h->array = malloc( h->size * sizeof(void*) );
+  assert(h->array != 0);
+
+  return h;
+}
+
+void insertHEAP(HEAP *items, void *value) {
+  if (items->filledIndices == items->size) {
+    items->size *= 2;
+    items->array = realloc( items->array, items->size * sizeof(void*) );
+    assert(items->array != 0);
+  }
+
+  /* sift up from the new leaf */
+  int i = items->filledIndices++;
+  items->array[i] = value;
+  while (i > 0 && items->compare(items->array[i], items->array[(i - 1) / 2]) < 0) {
+    swap(items->array, i, (i - 1) / 2);
+    i = (i - 1) / 2;
+  }
+}
+
+void *extractHEAP(HEAP *items) {
+  assert( items->filledIndices > 0 );
+
+  void *valToReturn = items->array[0];
+  items->filledIndices -= 1;
+  items->array[0] = items->array[items->filledIndices];
+
+  /* sift the old last leaf down from the root */
+  int i = 0;
+  while (1) {
+    int smallest = i;
+    int left = 2 * i + 1;
+    int right = left + 1;
+
+    if (left < items->filledIndices && items->compare(items->array[left], items->array[smallest]) < 0) { smallest = left; }
+    if (right < items->filledIndices && items->compare(items->array[right], items->array[smallest]) < 0) { smallest = right; }
+    if (smallest == i) { break; }
+
+    swap(items->array, i, smallest);
+    i = smallest;
+  }
+
+  return valToReturn;
+}
+
+void *peekHEAP(HEAP *items) {
+  assert( items->filledIndices > 0 );
+  return items->array[0];
+}
+
+int sizeHEAP(HEAP *items) {
+  return items->filledIndices;
+}
+
+void displayHEAP(FILE *fp, HEAP *items) {
+  fprintf(fp, "[");
+
+  int i;
+  for (i = 0; i < items->filledIndices; i++) {
+    items->display(fp, items->array[i]);
+    if (i != items->filledIndices - 1) { fprintf(fp, ","); }
+  }
+
+  fprintf(fp, "]");
+}
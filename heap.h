@@ -0,0 +1,18 @@
+/*This file serves as the header for the heap.c file
+ */
+
+#ifndef __HEAP_INCLUDED__
+#define __HEAP_INCLUDED__
+
+#include <stdio.h>
+
+typedef struct heap HEAP;
+
+extern HEAP *newHEAP(void (*d)(FILE *,void *),int (*c)(void *,void *));
+extern void insertHEAP(HEAP *items,void *value);
+extern void *extractHEAP(HEAP *items);
+extern void *peekHEAP(HEAP *items);
+extern int sizeHEAP(HEAP *items);
+extern void displayHEAP(FILE *,HEAP *items);
+
+#endif
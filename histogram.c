@@ -0,0 +1,111 @@
+/*This file serves as method implementations for the
+ *histogram object, which counts non-negative values in
+ *logarithmic buckets in the manner of an HDR histogram.
+ *Each power of two is split into SUB_BUCKETS linear
+ *buckets, so any value is reported to within 1/SUB_BUCKETS
+ *of itself while recording stays a couple of shifts and an
+ *increment, with a fixed footprint whatever the range.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <stdlib.h>
+#include "histogram.h"
+
+#define SUB_BITS 7
+#define SUB_BUCKETS (1 << (SUB_BITS - 1))       // linear buckets per power of two
+#define BUCKETS ((64 - SUB_BITS + 2) * SUB_BUCKETS)
+
+struct histogram {
+  long count;
+  long min;
+  long max;
+  double sum;
+  long counts[BUCKETS];
+};
+
+/*
+ *Values below 2^SUB_BITS get a bucket each. Above that, the value's top
+ *SUB_BITS bits pick the bucket and the discarded bits set the octave.
+ */
+static int bucket(long value) {
+  if (value < (1L << SUB_BITS))
+    return value;
+
+  int shift = 63 - __builtin_clzl(value) - (SUB_BITS - 1);
+  return shift * SUB_BUCKETS + (int) (value >> shift);
+}
+
+/*
+ *Returns the largest value that lands in the bucket
+ */
+static long highest(int index) {
+  if (index < (1 << SUB_BITS))
+    return index;
+
+  int shift = index / SUB_BUCKETS - 1;
+  long sub = index - shift * SUB_BUCKETS;
+  return ((sub + 1) << shift) - 1;
+}
+
+HISTOGRAM *newHISTOGRAM(void) {
+  HISTOGRAM *h = calloc( 1, sizeof(HISTOGRAM) );
+  assert(h != 0);
+
+  return h;
+}
+
+void freeHISTOGRAM(HISTOGRAM *items) {
+  free(items);
+}
+
+void recordHISTOGRAM(HISTOGRAM *items, long value) {
+  if (value < 0)
+    value = 0;
+
+  items->counts[bucket(value)] += 1;
+  if (items->count == 0 || value < items->min)
+    items->min = value;
+  if (value > items->max)
+    items->max = value;
+  items->count += 1;
+  items->sum += value;
+}
+
+/*
+ *Returns the value at or below which the given percentage of recorded
+ *values fall, rounded up to the top of its bucket, or 0 when empty
+ */
+long percentileHISTOGRAM(HISTOGRAM *items, double percentile) {
+  if (items->count == 0)
+    return 0;
+
+  long target = (long) (percentile / 100 * items->count + 0.5);
+  if (target < 1)
+    target = 1;
+
+  long seen = 0;
+  int i;
+  for (i = 0; i < BUCKETS; i++) {
+    seen += items->counts[i];
+    if (seen >= target)
+      return highest(i) < items->max ? highest(i) : items->max;
+  }
+  return items->max;
+}
+
+long countHISTOGRAM(HISTOGRAM *items) {
+  return items->count;
+}
+
+long minHISTOGRAM(HISTOGRAM *items) {
+  return items->min;
+}
+
+long maxHISTOGRAM(HISTOGRAM *items) {
+  return items->max;
+}
+
+double meanHISTOGRAM(HISTOGRAM *items) {
+  return items->count ? items->sum / items->count : 0;
+}
@@ -0,0 +1,20 @@
+/*This file serves as the header for the histogram.c file
+ */
+
+#ifndef __HISTOGRAM_INCLUDED__
+#define __HISTOGRAM_INCLUDED__
+
+#include <stdio.h>
+
+typedef struct histogram HISTOGRAM;
+
+extern HISTOGRAM *newHISTOGRAM(void);
+extern void freeHISTOGRAM(HISTOGRAM *items);
+extern void recordHISTOGRAM(HISTOGRAM *items,long value);
+extern long percentileHISTOGRAM(HISTOGRAM *items,double percentile);
+extern long countHISTOGRAM(HISTOGRAM *items);
+extern long minHISTOGRAM(HISTOGRAM *items);
+extern long maxHISTOGRAM(HISTOGRAM *items);
+extern double meanHISTOGRAM(HISTOGRAM *items);
+
+#endif
@@ -0,0 +1,33 @@
+/*This file defines the JOB record shared by the dispatcher
+ *and the job file loader
+ */
+
+#ifndef __JOB_INCLUDED__
+#define __JOB_INCLUDED__
+
+#include <sys/types.h>
+#include "runq.h"
+#include "control.h"
+#include "pairing.h"
+
+typedef struct JOB JOB;
+struct JOB
+{
+	pid_t pid;
+	int id;								// position in the input, from 1
+	int arrivalTime;					// seconds
+	int priority;
+	int processorTime;					// seconds, as given in the input
+	int deadline;						// seconds after arrival to finish by, 0 for none
+	int remainingProcessorTime;			// milliseconds
+	int cpu;							// slot the job last ran in
+	long queuedAt;						// milliseconds, when the job last joined a ready queue
+	long pass;							// stride scheduling virtual time, 0 before the job first joins
+	int awaiting;						// signal sent to the child and not yet acknowledged
+	long signalledAt;					// nanoseconds, when that signal was sent
+	CONTROL *control;					// shared-memory channel to the child, NULL for signals
+	RQLINK link;						// membership in a ready queue level
+	PHNODE node;						// membership in a ready heap
+};
+
+#endif
@@ -0,0 +1,158 @@
+/*Job file converter. Reads a text or binary job file and writes it
+ *in the other format, or in the one asked for.
+ *
+ *usage: jobconv [-b|-t] [-s] input [output]
+ *
+ *  -b  write binary, whatever the input is
+ *  -t  write text, whatever the input is
+ *  -s  sort the jobs by arrival, keeping file order among jobs that
+ *      arrive together; binary output is marked sorted whenever the
+ *      jobs end up in arrival order
+ *
+ *The output goes to standard output when no output file is given.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <endian.h>
+#include "jobfile.h"
+
+typedef struct entry ENTRY;
+struct entry {
+  JOBRECORD record;        // in host byte order until written
+  uint32_t order;          // position in the input
+};
+
+static ENTRY *entries;
+static uint32_t size, capacity;
+
+static void usage(char *name) {
+  fprintf(stderr, "usage: %s [-b|-t] [-s] input [output]\n", name);
+  exit(-1);
+}
+
+static void collect(JOB *j) {
+  if (size == capacity) {
+    capacity = capacity ? capacity * 2 : 1024;
+    entries = realloc(entries, capacity * sizeof(ENTRY));
+    if (!entries) {
+      fprintf(stderr, "Error: Out of memory\n");
+      exit(-1);
+    }
+  }
+
+  ENTRY *e = &entries[size];
+  e->record.arrival = j->arrivalTime;
+  e->record.priority = j->priority;
+  e->record.processorTime = j->processorTime;
+  e->record.deadline = j->deadline;
+  e->order = size++;
+}
+
+static int compareArrival(const void *a, const void *b) {
+  const ENTRY *x = a, *y = b;
+  if (x->record.arrival != y->record.arrival)
+    return x->record.arrival < y->record.arrival ? -1 : 1;
+  return x->order < y->order ? -1 : 1;
+}
+
+static int inArrivalOrder(void) {
+  uint32_t i;
+  for (i = 1; i < size; i++) {
+    if (entries[i].record.arrival < entries[i - 1].record.arrival)
+      return 0;
+  }
+  return 1;
+}
+
+static int isBinary(char *path) {
+  char magic[4];
+  FILE *fp = fopen(path, "rb");
+  int binary = fp && fread(magic, 1, 4, fp) == 4 && !memcmp(magic, JOBFILE_MAGIC, 4);
+  if (fp)
+    fclose(fp);
+  return binary;
+}
+
+static void writeBinary(FILE *fp) {
+  JOBHEADER header;
+  uint32_t i;
+
+  memcpy(header.magic, JOBFILE_MAGIC, 4);
+  header.version = htole16(JOBFILE_VERSION);
+  header.flags = htole16(inArrivalOrder() ? JOBFILE_SORTED : 0);
+  header.count = htole32(size);
+  header.recordSize = htole32(sizeof(JOBRECORD));
+  fwrite(&header, sizeof(header), 1, fp);
+
+  for (i = 0; i < size; i++) {
+    JOBRECORD r;
+    r.arrival = htole32(entries[i].record.arrival);
+    r.priority = htole32(entries[i].record.priority);
+    r.processorTime = htole32(entries[i].record.processorTime);
+    r.deadline = htole32(entries[i].record.deadline);
+    fwrite(&r, sizeof(r), 1, fp);
+  }
+}
+
+static void writeText(FILE *fp) {
+  uint32_t i;
+
+  for (i = 0; i < size; i++) {
+    JOBRECORD *r = &entries[i].record;
+    if (r->deadline)
+      fprintf(fp, "%u, %u, %u, %u\n", r->arrival, r->priority, r->processorTime, r->deadline);
+    else
+      fprintf(fp, "%u, %u, %u\n", r->arrival, r->priority, r->processorTime);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  int binary = -1;
+  int sort = 0;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "bts")) != -1) {
+    switch (opt) {
+      case 'b': binary = 1; break;
+      case 't': binary = 0; break;
+      case 's': sort = 1; break;
+      default: usage(argv[0]);
+    }
+  }
+
+  if (optind >= argc || argc - optind > 2)
+    usage(argv[0]);
+
+  char *input = argv[optind];
+  char *output = argc - optind == 2 ? argv[optind + 1] : NULL;
+
+  if (binary < 0)
+    binary = !isBinary(input);
+  if (loadJOBFILE(input, collect) < 0)
+    return -1;
+  if (sort)
+    qsort(entries, size, sizeof(ENTRY), compareArrival);
+
+  FILE *fp = output ? fopen(output, "wb") : stdout;
+  if (!fp) {
+    perror(output);
+    return -1;
+  }
+
+  static char buffer[1 << 16];
+  setvbuf(fp, buffer, _IOFBF, sizeof(buffer));
+
+  if (binary)
+    writeBinary(fp);
+  else
+    writeText(fp);
+
+  if (fclose(fp) != 0) {
+    perror(output ? output : "stdout");
+    return -1;
+  }
+  return 0;
+}
@@ -0,0 +1,216 @@
+/*This file serves as method implementations for the
+ *job file loader. The file is mapped into memory and each
+ *"<arrival>, <priority>, <processor time>[, <deadline>]" line
+ *is parsed in place into a JOB record on the stack, which is handed to the
+ *caller to copy into its own storage. Binary job files, told
+ *apart by their magic number, are mapped the same way and their
+ *fixed-width records read straight from the mapping with no
+ *parsing. Loading itself never allocates.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <endian.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "jobfile.h"
+
+#define MAX_DIGITS 9
+#define MAX_FIELD 999999999       // the most MAX_DIGITS digits can hold
+
+static const char *skipBlanks(const char *p, const char *end) {
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) { p++; }
+  return p;
+}
+
+/*
+ *Reads an unsigned decimal number, returning the position after it or
+ *NULL if there is no number (or it is too long to be one we accept).
+ */
+static const char *readNumber(const char *p, const char *end, int *value) {
+  const char *start = p;
+  int n = 0;
+
+  while (p < end && *p >= '0' && *p <= '9' && p - start < MAX_DIGITS) {
+    n = n * 10 + (*p - '0');
+    p++;
+  }
+
+  if (p == start || (p < end && *p >= '0' && *p <= '9')) { return NULL; }
+
+  *value = n;
+  return p;
+}
+
+/*
+ *Fills in a job record that has not been seen by the dispatcher yet
+ */
+void initJOB(JOB *job, int arrival, int priority, int processorTime, int deadline) {
+  job->pid = 0;
+  job->arrivalTime = arrival;
+  job->priority = priority;
+  job->processorTime = processorTime;
+  job->remainingProcessorTime = processorTime * 1000;
+  job->deadline = deadline;
+  job->cpu = -1;
+  job->queuedAt = 0;
+  job->pass = 0;
+  job->awaiting = 0;
+  job->signalledAt = 0;
+  job->control = NULL;
+  job->link.next = job->link.prev = NULL;
+}
+
+/*
+ *Parses one record between line and end (the newline excluded) into job.
+ *Returns 1 on success, 0 for a blank line and -1 for a malformed one.
+ */
+int parseJOB(const char *line, const char *end, JOB *job) {
+  int fields[4] = { 0, 0, 0, 0 };
+  const char *p = skipBlanks(line, end);
+  int i;
+
+  if (p == end) { return 0; }
+
+  /* the deadline is the one optional field */
+  for (i = 0; i < 4 && (i < 3 || p != end); i++) {
+    if (i > 0) {
+      if (p == end || *p != ',') { return -1; }
+      p = skipBlanks(p + 1, end);
+    }
+    if ((p = readNumber(p, end, &fields[i])) == NULL) { return -1; }
+    p = skipBlanks(p, end);
+  }
+
+  if (p != end || fields[2] > JOBFILE_MAX_PROCESSOR_TIME) { return -1; }
+
+  initJOB(job, fields[0], fields[1], fields[2], fields[3]);
+  return 1;
+}
+
+/*
+ *Parses every text record between text and end, as loadJOBFILE()
+ */
+static int loadText(char *path, const char *text, const char *end, void (*admit)(JOB *)) {
+  const char *p;
+  int n = 0;
+  int errors = 0;
+  int lineNumber = 0;
+
+  for (p = text; p < end; ) {
+    const char *eol = memchr(p, '\n', end - p);
+    if (eol == NULL) { eol = end; }
+    lineNumber++;
+
+    JOB job;
+    switch (parseJOB(p, eol, &job)) {
+      case 1:
+        job.id = ++n;
+        admit(&job);
+        break;
+      case -1:
+        fprintf(stderr, "Error: %s:%d: malformed job record\n", path, lineNumber);
+        errors++;
+        break;
+    }
+
+    p = eol + 1;
+  }
+
+  return errors ? -1 : n;
+}
+
+/*
+ *Reads every binary record between text and end, as loadJOBFILE(). The
+ *header must match this build's record layout and the file length, and
+ *each field must fit the range the text format allows.
+ */
+static int loadBinary(char *path, const char *text, const char *end, void (*admit)(JOB *)) {
+  const JOBHEADER *header = (const JOBHEADER *) text;
+  uint32_t count = le32toh(header->count);
+  uint16_t flags = le16toh(header->flags);
+
+  if (le16toh(header->version) != JOBFILE_VERSION || le32toh(header->recordSize) != sizeof(JOBRECORD)) {
+    fprintf(stderr, "Error: %s: unsupported binary job file version\n", path);
+    return -1;
+  }
+  if ((size_t) (end - text - sizeof(JOBHEADER)) != (size_t) count * sizeof(JOBRECORD)) {
+    fprintf(stderr, "Error: %s: binary job file length does not match its header\n", path);
+    return -1;
+  }
+
+  const JOBRECORD *records = (const JOBRECORD *) (text + sizeof(JOBHEADER));
+  uint32_t last = 0;
+  uint32_t i;
+  int errors = 0;
+
+  for (i = 0; i < count; i++) {
+    uint32_t arrival = le32toh(records[i].arrival);
+    uint32_t priority = le32toh(records[i].priority);
+    uint32_t processorTime = le32toh(records[i].processorTime);
+    uint32_t deadline = le32toh(records[i].deadline);
+
+    if (arrival > MAX_FIELD || priority > MAX_FIELD || processorTime > JOBFILE_MAX_PROCESSOR_TIME || deadline > MAX_FIELD
+        || ((flags & JOBFILE_SORTED) && arrival < last)) {
+      fprintf(stderr, "Error: %s: record %u: malformed job record\n", path, i + 1);
+      errors++;
+      continue;
+    }
+    last = arrival;
+
+    JOB job;
+    initJOB(&job, arrival, priority, processorTime, deadline);
+    job.id = i + 1;
+    admit(&job);
+  }
+
+  return errors ? -1 : (int) count;
+}
+
+/*
+ *Parses every job in the text or binary file at path and hands each
+ *record to admit, numbered from 1 in file order. Each malformed record is
+ *reported on stderr with its line or record number. Returns the number of
+ *jobs, or -1 if the file could not be read or any record was malformed.
+ */
+int loadJOBFILE(char *path, void (*admit)(JOB *)) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    fprintf(stderr, "Error: Could not open job file %s\n", path);
+    return -1;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) < 0) {
+    fprintf(stderr, "Error: Could not stat job file %s\n", path);
+    close(fd);
+    return -1;
+  }
+
+  if (st.st_size == 0) {
+    close(fd);
+    return 0;
+  }
+
+  const char *text = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+  close(fd);
+  if (text == MAP_FAILED) {
+    fprintf(stderr, "Error: Could not map job file %s\n", path);
+    return -1;
+  }
+  madvise((void *) text, st.st_size, MADV_SEQUENTIAL);
+
+  const char *end = text + st.st_size;
+  int n;
+
+  if ((size_t) st.st_size >= sizeof(JOBHEADER) && !memcmp(text, JOBFILE_MAGIC, 4))
+    n = loadBinary(path, text, end, admit);
+  else
+    n = loadText(path, text, end, admit);
+
+  munmap((void *) text, st.st_size);
+
+  return n;
+}
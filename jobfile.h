@@ -0,0 +1,44 @@
+/*This file serves as the header for the jobfile.c file
+ */
+
+#ifndef __JOBFILE_INCLUDED__
+#define __JOBFILE_INCLUDED__
+
+#include <stdint.h>
+#include <limits.h>
+#include "job.h"
+
+/* the longest processor time, in seconds, whose milliseconds fit an int */
+#define JOBFILE_MAX_PROCESSOR_TIME (INT_MAX / 1000)
+
+/*
+ *Binary job files are a JOBHEADER followed by count JOBRECORDs, every
+ *field little-endian. With JOBFILE_SORTED set the records are in arrival
+ *order, so they reach the dispatch list without reordering.
+ */
+#define JOBFILE_MAGIC "JOBS"
+#define JOBFILE_VERSION 1
+#define JOBFILE_SORTED 0x1
+
+typedef struct jobheader JOBHEADER;
+struct jobheader {
+  char magic[4];
+  uint16_t version;
+  uint16_t flags;
+  uint32_t count;
+  uint32_t recordSize;     // sizeof(JOBRECORD) when written
+};
+
+typedef struct jobrecord JOBRECORD;
+struct jobrecord {
+  uint32_t arrival;        // seconds
+  uint32_t priority;
+  uint32_t processorTime;  // seconds
+  uint32_t deadline;       // seconds after arrival, 0 for none
+};
+
+extern int loadJOBFILE(char *path,void (*admit)(JOB *));
+extern int parseJOB(const char *line,const char *end,JOB *job);
+extern void initJOB(JOB *job,int arrival,int priority,int processorTime,int deadline);
+
+#endif
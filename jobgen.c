@@ -0,0 +1,168 @@
+/*Synthetic workload generator. Writes job files in the dispatcher's
+ *<arrival>, <priority>, <processor time> format, in arrival order.
+ *
+ *usage: jobgen [-n jobs] [-a poisson|bursty|diurnal] [-r rate]
+ *              [-P period] [-p w0,w1,...] [-d fixed|uniform|exp|pareto]
+ *              [-m mean] [-s seed]
+ *
+ *  -n  number of jobs (default 1000)
+ *  -a  arrival process (default poisson):
+ *        poisson  exponential gaps at the mean rate
+ *        bursty   alternates bursts at 4.6 times the rate with quiet
+ *                 spells at a tenth of it, each lasting an exponential
+ *                 time with a mean of 5 and 20 seconds, which keeps
+ *                 the mean rate as asked
+ *        diurnal  poisson with a rate that swings +/-80% sinusoidally
+ *                 over the period
+ *  -r  mean arrivals per second (default 1)
+ *  -P  diurnal period in seconds (default 3600)
+ *  -p  relative weights of priorities 0, 1, ... (default 1,3,3,3)
+ *  -d  processor time distribution (default exp), truncated to
+ *      whole seconds, at least one and at most what the job file accepts:
+ *        fixed    always the mean
+ *        uniform  1 to 2*mean-1
+ *        exp      exponential
+ *        pareto   heavy tailed, shape 1.5
+ *  -m  mean processor time in seconds (default 3)
+ *  -s  random seed (default 1)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "jobfile.h"
+
+#define MAX_PRIORITIES 256
+
+static uint64_t state;
+
+/* splitmix64, so the same seed gives the same file everywhere */
+static double uniform(void) {
+  uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  z ^= z >> 31;
+  return ((z >> 11) + 0.5) / 9007199254740992.0;   // (0, 1)
+}
+
+static double exponential(double mean) {
+  return -mean * log(uniform());
+}
+
+static void usage(char *name) {
+  fprintf(stderr, "usage: %s [-n jobs] [-a poisson|bursty|diurnal] [-r rate] [-P period]\n"
+      "       [-p w0,w1,...] [-d fixed|uniform|exp|pareto] [-m mean] [-s seed]\n", name);
+  exit(-1);
+}
+
+/* arrival time of the next job, in seconds since the start */
+static double nextArrival(char *process, double now, double rate, double period) {
+  static int bursting = 1;
+  static double phaseEnd = -1;
+
+  if (!strcmp(process, "poisson"))
+    return now + exponential(1 / rate);
+
+  if (!strcmp(process, "bursty")) {
+    for (;;) {
+      if (phaseEnd < 0)
+        phaseEnd = now + exponential(5);
+      double next = now + exponential(1 / (bursting ? rate * 4.6 : rate / 10));
+      if (next < phaseEnd)
+        return next;
+
+      /* nothing arrived before the phase ended; the gaps are memoryless */
+      now = phaseEnd;
+      bursting = !bursting;
+      phaseEnd = now + exponential(bursting ? 5 : 20);
+    }
+  }
+
+  /* diurnal: thin a poisson process running at the peak rate */
+  for (;;) {
+    now += exponential(1 / (rate * 1.8));
+    double level = 1 + 0.8 * sin(2 * M_PI * now / period);
+    if (uniform() * 1.8 < level)
+      return now;
+  }
+}
+
+static long processorTime(char *distribution, double mean) {
+  double t;
+
+  if (!strcmp(distribution, "fixed"))
+    t = mean;
+  else if (!strcmp(distribution, "uniform"))
+    t = 1 + uniform() * (2 * mean - 1);
+  else if (!strcmp(distribution, "pareto"))
+    t = mean / 3 / pow(uniform(), 1 / 1.5);     // scale so the mean is as asked
+  else
+    t = exponential(mean);
+
+  if (t < 1)
+    return 1;
+  return t > JOBFILE_MAX_PROCESSOR_TIME ? JOBFILE_MAX_PROCESSOR_TIME : (long) t;
+}
+
+int main(int argc, char *argv[]) {
+  long n = 1000;
+  char *process = "poisson";
+  char *distribution = "exp";
+  double rate = 1, period = 3600, mean = 3;
+  double weights[MAX_PRIORITIES] = { 1, 3, 3, 3 };
+  int priorities = 4;
+  int opt;
+
+  state = 1;
+  while ((opt = getopt(argc, argv, "n:a:r:P:p:d:m:s:")) != -1) {
+    switch (opt) {
+      case 'n': n = atol(optarg); break;
+      case 'a': process = optarg; break;
+      case 'r': rate = atof(optarg); break;
+      case 'P': period = atof(optarg); break;
+      case 'd': distribution = optarg; break;
+      case 'm': mean = atof(optarg); break;
+      case 's': state = strtoull(optarg, NULL, 10); break;
+      case 'p': {
+        char *w = strtok(optarg, ",");
+        for (priorities = 0; w && priorities < MAX_PRIORITIES; w = strtok(NULL, ","))
+          weights[priorities++] = atof(w);
+        break;
+      }
+      default: usage(argv[0]);
+    }
+  }
+
+  if (n < 0 || rate <= 0 || period <= 0 || mean < 1 || priorities == 0
+      || (strcmp(process, "poisson") && strcmp(process, "bursty") && strcmp(process, "diurnal")))
+    usage(argv[0]);
+
+  /* cumulative weights, to pick a priority with one uniform draw */
+  double total = 0;
+  int i;
+  for (i = 0; i < priorities; i++) {
+    total += weights[i];
+    weights[i] = total;
+  }
+
+  static char buffer[1 << 16];
+  setvbuf(stdout, buffer, _IOFBF, sizeof(buffer));
+
+  double now = 0;
+  long j;
+  for (j = 0; j < n; j++) {
+    now = nextArrival(process, now, rate, period);
+
+    double pick = uniform() * total;
+    int priority = 0;
+    while (priority < priorities - 1 && pick >= weights[priority])
+      priority += 1;
+
+    printf("%ld, %d, %ld\n", (long) now, priority, processorTime(distribution, mean));
+  }
+
+  return 0;
+}
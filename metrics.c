@@ -0,0 +1,311 @@
+/*This file serves as method implementations for the
+ *metrics object, which records the scheduling history of
+ *every job by id: arrival, first run, each suspend and
+ *resume, and completion, all in dispatcher milliseconds.
+ *Records outlive the jobs themselves, so a report can be
+ *written at any time. Jobs are grouped for the per-queue
+ *aggregates by the level they arrived in. Under a proportional
+ *share policy the report also compares each level's share of
+ *the slices with the share its tickets entitled it to, and
+ *when any job has a deadline it sums up how many were refused
+ *and how many of the rest were missed.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <stdlib.h>
+#include "metrics.h"
+#include "histogram.h"
+
+typedef struct jobstat JOBSTAT;
+struct jobstat {
+  int level;
+  int suspends;
+  int resumes;
+  long arrival;
+  long firstRun;       // -1 until the job first runs
+  long lastRun;        // start of the current run, -1 while not running
+  long ran;            // milliseconds spent running
+  long completion;     // -1 until the job completes
+  long deadline;       // time to complete by, -1 for none
+  int rejected;        // deadline refused on admission
+};
+
+typedef struct queuestat QUEUESTAT;
+struct queuestat {
+  int jobs;
+  int completed;
+  int started;
+  long switches;
+  double turnaround;
+  double waiting;
+  double response;
+  HISTOGRAM *turnarounds;
+};
+
+struct metrics {
+  int levels;
+  int size;            // ids 1..size have records
+  int capacity;
+  JOBSTAT *stats;
+  int deadlines;       // jobs with a deadline
+  double *target;      // slices each level was owed, NULL without shares
+  double *achieved;    // slices each level got
+};
+
+static JOBSTAT *stat(METRICS *items, int id) {
+  assert( id >= 1 && id <= items->size );
+  return &items->stats[id - 1];
+}
+
+METRICS *newMETRICS(int levels) {
+  METRICS *m = malloc( sizeof(METRICS) );
+  assert(m != 0);
+
+  m->levels = levels;
+  m->size = 0;
+  m->capacity = 1024;
+  m->stats = malloc( m->capacity * sizeof(JOBSTAT) );
+  assert(m->stats != 0);
+  m->deadlines = 0;
+  m->target = NULL;
+  m->achieved = NULL;
+
+  return m;
+}
+
+/*
+ *Records a job's arrival, and the time it must complete by or -1. Ids
+ *are handed out in order from 1, so each arrival appends a record.
+ */
+void arriveMETRICS(METRICS *items, int id, int level, long time, long deadline) {
+  assert( id == items->size + 1 );
+
+  if (items->size == items->capacity) {
+    items->capacity *= 2;
+    items->stats = realloc( items->stats, items->capacity * sizeof(JOBSTAT) );
+    assert(items->stats != 0);
+  }
+
+  JOBSTAT *s = &items->stats[items->size++];
+  s->level = level < items->levels ? level : items->levels - 1;
+  s->suspends = 0;
+  s->resumes = 0;
+  s->arrival = time;
+  s->firstRun = -1;
+  s->lastRun = -1;
+  s->ran = 0;
+  s->completion = -1;
+  s->deadline = deadline;
+  s->rejected = 0;
+  if (deadline >= 0)
+    items->deadlines += 1;
+}
+
+/*
+ *Records that a job's deadline was refused, so it runs without one
+ */
+void rejectMETRICS(METRICS *items, int id) {
+  stat(items, id)->rejected = 1;
+}
+
+/*
+ *Records a job being started or resumed on a CPU
+ */
+void runMETRICS(METRICS *items, int id, long time) {
+  JOBSTAT *s = stat(items, id);
+
+  if (s->firstRun < 0)
+    s->firstRun = time;
+  else
+    s->resumes += 1;
+  s->lastRun = time;
+}
+
+void suspendMETRICS(METRICS *items, int id, long time) {
+  JOBSTAT *s = stat(items, id);
+
+  s->suspends += 1;
+  s->ran += time - s->lastRun;
+  s->lastRun = -1;
+}
+
+void completeMETRICS(METRICS *items, int id, long time) {
+  JOBSTAT *s = stat(items, id);
+
+  if (s->lastRun >= 0)
+    s->ran += time - s->lastRun;
+  s->lastRun = -1;
+  s->completion = time;
+}
+
+/*
+ *Replaces the per-level slice counts the next report compares, owed in
+ *target[] and handed out in achieved[], each indexed by level
+ */
+void sharesMETRICS(METRICS *items, double *target, double *achieved) {
+  int level;
+
+  if (!items->target) {
+    items->target = malloc( items->levels * sizeof(double) );
+    items->achieved = malloc( items->levels * sizeof(double) );
+    assert(items->target != 0 && items->achieved != 0);
+  }
+  for (level = 0; level < items->levels; level++) {
+    items->target[level] = target[level];
+    items->achieved[level] = achieved[level];
+  }
+}
+
+/* met and missed count admitted jobs that have completed */
+static void reportDeadlines(FILE *fp, METRICS *items, int json) {
+  int rejected = 0, met = 0, missed = 0;
+  long lateness = 0;
+  int i;
+
+  for (i = 0; i < items->size; i++) {
+    JOBSTAT *s = &items->stats[i];
+
+    if (s->deadline < 0)
+      continue;
+    if (s->rejected)
+      rejected += 1;
+    else if (s->completion > s->deadline) {
+      missed += 1;
+      if (s->completion - s->deadline > lateness)
+        lateness = s->completion - s->deadline;
+    }
+    else if (s->completion >= 0)
+      met += 1;
+  }
+
+  if (json)
+    fprintf(fp, ", \"deadlines\": {\"jobs\": %d, \"rejected\": %d, \"met\": %d, "
+        "\"missed\": %d, \"max_lateness\": %ld}",
+        items->deadlines, rejected, met, missed, lateness);
+  else
+    fprintf(fp, "\ndeadline_jobs,rejected,met,missed,max_lateness\n%d,%d,%d,%d,%ld\n",
+        items->deadlines, rejected, met, missed, lateness);
+}
+
+static void reportShares(FILE *fp, METRICS *items, int json) {
+  double owed = 0, given = 0;
+  int level;
+
+  for (level = 0; level < items->levels; level++) {
+    owed += items->target[level];
+    given += items->achieved[level];
+  }
+
+  if (json)
+    fprintf(fp, ", \"shares\": [");
+  else
+    fprintf(fp, "\nqueue,slices,target_share,achieved_share\n");
+
+  for (level = 0; level < items->levels; level++) {
+    double target = owed > 0 ? items->target[level] / owed : 0;
+    double achieved = given > 0 ? items->achieved[level] / given : 0;
+
+    if (json)
+      fprintf(fp, "%s\n  {\"queue\": %d, \"slices\": %.0f, \"target_share\": %.4f, \"achieved_share\": %.4f}",
+          level ? "," : "", level, items->achieved[level], target, achieved);
+    else
+      fprintf(fp, "%d,%.0f,%.4f,%.4f\n", level, items->achieved[level], target, achieved);
+  }
+
+  if (json)
+    fprintf(fp, "\n]");
+}
+
+/*
+ *Writes one record per job followed by one per queue level, as CSV or
+ *as a JSON object. Times a job has not reached yet are written as -1
+ *and left out of the queue averages.
+ */
+void reportMETRICS(FILE *fp, METRICS *items, int json) {
+  int i;
+
+  if (json)
+    fprintf(fp, "{\"jobs\": [");
+  else
+    fprintf(fp, "id,queue,arrival,first_run,completion,turnaround,waiting,response,suspends,resumes,context_switches\n");
+
+  for (i = 0; i < items->size; i++) {
+    JOBSTAT *s = &items->stats[i];
+    long response = s->firstRun < 0 ? -1 : s->firstRun - s->arrival;
+    long turnaround = s->completion < 0 ? -1 : s->completion - s->arrival;
+    long waiting = s->completion < 0 ? -1 : turnaround - s->ran;
+    int switches = s->suspends + s->resumes;
+
+    if (json)
+      fprintf(fp, "%s\n  {\"id\": %d, \"queue\": %d, \"arrival\": %ld, \"first_run\": %ld, "
+          "\"completion\": %ld, \"turnaround\": %ld, \"waiting\": %ld, \"response\": %ld, "
+          "\"suspends\": %d, \"resumes\": %d, \"context_switches\": %d}",
+          i ? "," : "", i + 1, s->level, s->arrival, s->firstRun, s->completion,
+          turnaround, waiting, response, s->suspends, s->resumes, switches);
+    else
+      fprintf(fp, "%d,%d,%ld,%ld,%ld,%ld,%ld,%ld,%d,%d,%d\n",
+          i + 1, s->level, s->arrival, s->firstRun, s->completion,
+          turnaround, waiting, response, s->suspends, s->resumes, switches);
+  }
+
+  if (json)
+    fprintf(fp, "\n], \"queues\": [");
+  else
+    fprintf(fp, "\nqueue,jobs,completed,mean_turnaround,p99_turnaround,mean_waiting,mean_response,context_switches\n");
+
+  /* one pass over the jobs fills every level's totals */
+  QUEUESTAT *q = calloc( items->levels, sizeof(QUEUESTAT) );
+  assert(q != 0);
+
+  int level;
+  for (level = 0; level < items->levels; level++)
+    q[level].turnarounds = newHISTOGRAM();
+
+  for (i = 0; i < items->size; i++) {
+    JOBSTAT *s = &items->stats[i];
+    QUEUESTAT *t = &q[s->level];
+
+    t->jobs += 1;
+    t->switches += s->suspends + s->resumes;
+    if (s->firstRun >= 0) {
+      t->started += 1;
+      t->response += s->firstRun - s->arrival;
+    }
+    if (s->completion >= 0) {
+      t->completed += 1;
+      t->turnaround += s->completion - s->arrival;
+      recordHISTOGRAM(t->turnarounds, s->completion - s->arrival);
+      t->waiting += s->completion - s->arrival - s->ran;
+    }
+  }
+
+  for (level = 0; level < items->levels; level++) {
+    QUEUESTAT *t = &q[level];
+    long p99 = percentileHISTOGRAM(t->turnarounds, 99);
+    double turnaround = t->completed ? t->turnaround / t->completed : 0;
+    double waiting = t->completed ? t->waiting / t->completed : 0;
+    double response = t->started ? t->response / t->started : 0;
+
+    if (json)
+      fprintf(fp, "%s\n  {\"queue\": %d, \"jobs\": %d, \"completed\": %d, \"mean_turnaround\": %.1f, "
+          "\"p99_turnaround\": %ld, \"mean_waiting\": %.1f, \"mean_response\": %.1f, \"context_switches\": %ld}",
+          level ? "," : "", level, t->jobs, t->completed, turnaround, p99, waiting, response, t->switches);
+    else
+      fprintf(fp, "%d,%d,%d,%.1f,%ld,%.1f,%.1f,%ld\n",
+          level, t->jobs, t->completed, turnaround, p99, waiting, response, t->switches);
+    freeHISTOGRAM(t->turnarounds);
+  }
+  free(q);
+
+  if (json)
+    fprintf(fp, "\n]");
+  if (items->target)
+    reportShares(fp, items, json);
+  if (items->deadlines)
+    reportDeadlines(fp, items, json);
+
+  if (json)
+    fprintf(fp, "}\n");
+  fflush(fp);
+}
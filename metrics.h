@@ -0,0 +1,20 @@
+/*This file serves as the header for the metrics.c file
+ */
+
+#ifndef __METRICS_INCLUDED__
+#define __METRICS_INCLUDED__
+
+#include <stdio.h>
+
+typedef struct metrics METRICS;
+
+extern METRICS *newMETRICS(int levels);
+extern void arriveMETRICS(METRICS *items,int id,int level,long time,long deadline);
+extern void rejectMETRICS(METRICS *items,int id);
+extern void runMETRICS(METRICS *items,int id,long time);
+extern void suspendMETRICS(METRICS *items,int id,long time);
+extern void completeMETRICS(METRICS *items,int id,long time);
+extern void sharesMETRICS(METRICS *items,double *target,double *achieved);
+extern void reportMETRICS(FILE *,METRICS *items,int json);
+
+#endif
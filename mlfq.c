@@ -0,0 +1,147 @@
+/*This file serves as method implementations for the
+ *multilevel feedback queue object. Level 0 is the highest
+ *priority. A two-level bitmap tracks which levels are non-empty,
+ *so finding the highest ready level is two find-first-set
+ *operations no matter how many levels there are. Each level
+ *is an intrusive run queue, so no operation allocates.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <stdlib.h>
+#include "mlfq.h"
+
+#define WORDS (MLFQ_MAX_LEVELS / 64)
+
+struct mlfq {
+  void (*display)(FILE *, void *);
+  int levels;
+  int size;
+  unsigned long long summary;         // bit w set when words[w] != 0
+  unsigned long long words[WORDS];    // bit l%64 of word l/64 set when level l is non-empty
+  RUNQ **queues;
+};
+
+static void markLevel(MLFQ *items, int level) {
+  items->words[level / 64] |= 1ULL << (level % 64);
+  items->summary |= 1ULL << (level / 64);
+}
+
+static void clearLevel(MLFQ *items, int level) {
+  items->words[level / 64] &= ~(1ULL << (level % 64));
+  if (items->words[level / 64] == 0) { items->summary &= ~(1ULL << (level / 64)); }
+}
+
+MLFQ *newMLFQ(int levels, void (*d)(FILE *, void *)) {
+  assert( levels > 0 && levels <= MLFQ_MAX_LEVELS );
+
+  MLFQ *m = malloc( sizeof(MLFQ) );
+  assert(m != 0);
+
+  m->display = d;
+  m->levels = levels;
+  m->size = 0;
+  m->summary = 0;
+
+  int i;
+  for (i = 0; i < WORDS; i++) { m->words[i] = 0; }
+
+  m->queues = malloc( levels * sizeof(RUNQ*) );
+  assert(m->queues != 0);
+  for (i = 0; i < levels; i++) { m->queues[i] = newRUNQ(d); }
+
+  return m;
+}
+
+void enqueueMLFQ(MLFQ *items, int level, RQLINK *link) {
+  assert( level >= 0 && level < items->levels );
+
+  enqueueRUNQ(items->queues[level], link);
+  markLevel(items, level);
+  items->size += 1;
+}
+
+/*
+ *Removes and returns the value at the front of the highest
+ *priority non-empty level.
+ */
+RQLINK *dequeueMLFQ(MLFQ *items) {
+  int level = highestMLFQ(items);
+  assert( level >= 0 );
+
+  RQLINK *link = dequeueRUNQ(items->queues[level]);
+  if (sizeRUNQ(items->queues[level]) == 0) { clearLevel(items, level); }
+  items->size -= 1;
+
+  return link;
+}
+
+/*
+ *Removes a value from the middle of the given level in O(1), for
+ *cancelling or reprioritizing it.
+ */
+void removeMLFQ(MLFQ *items, int level, RQLINK *link) {
+  assert( level >= 0 && level < items->levels );
+
+  removeRUNQ(items->queues[level], link);
+  if (sizeRUNQ(items->queues[level]) == 0) { clearLevel(items, level); }
+  items->size -= 1;
+}
+
+/*
+ *Removes and returns the value at the back of the highest priority
+ *non-empty level: the most urgent work, but the entry that has waited
+ *least, for another queue to take over.
+ */
+RQLINK *stealMLFQ(MLFQ *items) {
+  int level = highestMLFQ(items);
+  assert( level >= 0 );
+
+  RQLINK *link = peekRUNQback(items->queues[level]);
+  removeMLFQ(items, level, link);
+
+  return link;
+}
+
+/*
+ *Returns the highest priority non-empty level, or -1 if every level is empty.
+ */
+int highestMLFQ(MLFQ *items) {
+  if (items->summary == 0) { return -1; }
+
+  int w = __builtin_ctzll(items->summary);
+  return w * 64 + __builtin_ctzll(items->words[w]);
+}
+
+int levelsMLFQ(MLFQ *items) {
+  return items->levels;
+}
+
+int sizeMLFQ(MLFQ *items) {
+  return items->size;
+}
+
+int sizeMLFQlevel(MLFQ *items, int level) {
+  assert( level >= 0 && level < items->levels );
+  return sizeRUNQ(items->queues[level]);
+}
+
+/*
+ *Returns the value at the front of a level, which has waited there longest
+ */
+RQLINK *peekMLFQlevel(MLFQ *items, int level) {
+  assert( level >= 0 && level < items->levels );
+  return peekRUNQ(items->queues[level]);
+}
+
+void displayMLFQ(FILE *fp, MLFQ *items) {
+  fprintf(fp, "{");
+
+  int i;
+  for (i = 0; i < items->levels; i++) {
+    displayRUNQ(fp, items->queues[i]);
+    if (i != items->levels - 1) { fprintf(fp, ","); }
+  }
+
+  fprintf(fp, "}");
+}
@@ -0,0 +1,26 @@
+/*This file serves as the header for the mlfq.c file
+ */
+
+#ifndef __MLFQ_INCLUDED__
+#define __MLFQ_INCLUDED__
+
+#include <stdio.h>
+#include "runq.h"
+
+#define MLFQ_MAX_LEVELS 256
+
+typedef struct mlfq MLFQ;
+
+extern MLFQ *newMLFQ(int levels,void (*d)(FILE *,void *));
+extern void enqueueMLFQ(MLFQ *items,int level,RQLINK *link);
+extern RQLINK *dequeueMLFQ(MLFQ *items);
+extern void removeMLFQ(MLFQ *items,int level,RQLINK *link);
+extern RQLINK *stealMLFQ(MLFQ *items);
+extern int highestMLFQ(MLFQ *items);
+extern int levelsMLFQ(MLFQ *items);
+extern int sizeMLFQ(MLFQ *items);
+extern int sizeMLFQlevel(MLFQ *items,int level);
+extern RQLINK *peekMLFQlevel(MLFQ *items,int level);
+extern void displayMLFQ(FILE *,MLFQ *items);
+
+#endif
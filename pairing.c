@@ -0,0 +1,147 @@
+/*This file serves as method implementations for the
+ *pairing heap object, an intrusive min-heap: values embed a
+ *PHNODE and the heap only links them, so it never allocates.
+ *Insertion is O(1), extraction and decrease-key are O(log n)
+ *amortized. The comparator returns a negative number when
+ *its first argument belongs closer to the top.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <stdlib.h>
+#include "pairing.h"
+
+struct pairing {
+  int (*compare)(PHNODE *, PHNODE *);
+  int size;
+  PHNODE *root;
+};
+
+/*
+ *Makes the loser of two roots the leftmost child of the winner and
+ *returns the winner
+ */
+static PHNODE *meld(PAIRING *items, PHNODE *a, PHNODE *b) {
+  if (items->compare(b, a) < 0) {
+    PHNODE *tmp = a;
+    a = b;
+    b = tmp;
+  }
+
+  b->prev = a;
+  b->next = a->child;
+  if (a->child) { a->child->prev = b; }
+  a->child = b;
+
+  return a;
+}
+
+PAIRING *newPAIRING(int (*c)(PHNODE *, PHNODE *)) {
+  PAIRING *h = malloc( sizeof(PAIRING) );
+  assert(h != 0);
+
+  h->compare = c;
+  h->size = 0;
+  h->root = NULL;
+
+  return h;
+}
+
+void insertPAIRING(PAIRING *items, PHNODE *node) {
+  node->child = node->next = node->prev = NULL;
+  items->root = items->root ? meld(items, items->root, node) : node;
+  items->size++;
+}
+
+/*
+ *Removes the root and melds its children back into one tree in two
+ *passes: pairs left to right, then the pairs right to left. Both passes
+ *are loops, so deep heaps cannot exhaust the stack.
+ */
+PHNODE *extractPAIRING(PAIRING *items) {
+  assert( items->size > 0 );
+
+  PHNODE *top = items->root;
+  PHNODE *pairs = NULL;           // melded pairs, last first, linked by next
+  PHNODE *first = top->child;
+
+  while (first) {
+    PHNODE *a = first;
+    PHNODE *b = a->next;
+    first = b ? b->next : NULL;
+
+    a->next = a->prev = NULL;
+    if (b) {
+      b->next = b->prev = NULL;
+      a = meld(items, a, b);
+    }
+    a->next = pairs;
+    pairs = a;
+  }
+
+  PHNODE *root = pairs;
+  if (root) {
+    pairs = root->next;
+    root->next = NULL;
+    while (pairs) {
+      PHNODE *next = pairs->next;
+      pairs->next = NULL;
+      root = meld(items, root, pairs);
+      pairs = next;
+    }
+  }
+
+  items->root = root;
+  items->size--;
+  top->child = top->next = top->prev = NULL;
+
+  return top;
+}
+
+PHNODE *peekPAIRING(PAIRING *items) {
+  assert( items->size > 0 );
+  return items->root;
+}
+
+/*
+ *Restores the heap after a node's key has been lowered, by cutting its
+ *subtree loose and melding it with the root
+ */
+void decreasePAIRING(PAIRING *items, PHNODE *node) {
+  if (node == items->root) { return; }
+
+  if (node->prev->child == node) { node->prev->child = node->next; }
+  else { node->prev->next = node->next; }
+  if (node->next) { node->next->prev = node->prev; }
+
+  node->next = node->prev = NULL;
+  items->root = meld(items, items->root, node);
+}
+
+int sizePAIRING(PAIRING *items) {
+  return items->size;
+}
+
+/*
+ *Calls visit on every node, in no particular order, in O(n) and without
+ *recursion. A node's parent is found through its leftmost sibling, whose
+ *prev is the parent.
+ */
+void walkPAIRING(PAIRING *items, void (*visit)(PHNODE *, void *), void *arg) {
+  PHNODE *node = items->root;
+
+  while (node) {
+    visit(node, arg);
+
+    if (node->child) {
+      node = node->child;
+      continue;
+    }
+
+    while (node != items->root && !node->next) {
+      while (node->prev->child != node) { node = node->prev; }
+      node = node->prev;
+    }
+    node = node == items->root ? NULL : node->next;
+  }
+}
@@ -0,0 +1,29 @@
+/*This file serves as the header for the pairing.c file
+ */
+
+#ifndef __PAIRING_INCLUDED__
+#define __PAIRING_INCLUDED__
+
+#include <stddef.h>
+
+typedef struct phnode PHNODE;
+struct phnode {
+  PHNODE *child;
+  PHNODE *next;
+  PHNODE *prev;       // left sibling, or the parent of a leftmost child
+};
+
+/* recovers the object a node is embedded in, e.g. PAIRING_ENTRY(n, JOB, node) */
+#define PAIRING_ENTRY(n,type,member) ((type *) ((char *) (n) - offsetof(type, member)))
+
+typedef struct pairing PAIRING;
+
+extern PAIRING *newPAIRING(int (*c)(PHNODE *,PHNODE *));
+extern void insertPAIRING(PAIRING *items,PHNODE *node);
+extern PHNODE *extractPAIRING(PAIRING *items);
+extern PHNODE *peekPAIRING(PAIRING *items);
+extern void decreasePAIRING(PAIRING *items,PHNODE *node);
+extern int sizePAIRING(PAIRING *items);
+extern void walkPAIRING(PAIRING *items,void (*visit)(PHNODE *,void *),void *arg);
+
+#endif
@@ -0,0 +1,402 @@
+/*This file serves as method implementations for the
+ *scheduling policies the dispatcher can run:
+ *
+ *  fcfs  first come first served, never preempts
+ *  rr    round robin, preempts whenever another job waits
+ *  mlfq  multilevel feedback queue: level 0 is the system
+ *        queue and is never preempted, user jobs drop a
+ *        level each time they are preempted and, with aging,
+ *        climb back a level (but never into level 0) each
+ *        time they wait the aging threshold. System jobs with
+ *        a deadline run earliest deadline first ahead of the
+ *        rest of level 0, if they pass an admission test
+ *  sjf   shortest job first by processor time, never preempts
+ *  srtf  shortest remaining time first, preempting at the end
+ *        of a slice when a waiting job has less left to run
+ *  stride  proportional share: a priority p job holds levels - p
+ *        tickets and gets slices in proportion to them, lowest
+ *        pass first, instead of strict precedence by level
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "policy.h"
+#include "runq.h"
+#include "mlfq.h"
+#include "pairing.h"
+
+/* each policy uses the one structure that suits it */
+typedef struct ready READY;
+struct ready {
+  int levels;
+  long aging;          // milliseconds a queued job waits before promotion, 0 for never
+  RUNQ *fifo;
+  MLFQ *mlfq;
+  PAIRING *heap;       // mlfq: admitted system jobs by deadline
+  JOB **scratch;       // mlfq: deadline jobs gathered for admission
+  int scratchSize;
+  int gathered;
+  long pass;           // stride: pass of the last job picked
+  long *tickets;       // stride: tickets held by each level's ready jobs
+  double *target;      // stride: slices each level was owed
+  double *achieved;    // stride: slices each level got
+};
+
+static void displayLink(FILE *fp, void *link) {
+  JOB *j = RUNQ_ENTRY(link, JOB, link);
+  fprintf(fp, "<%d>, <%d>, <%d>", j->arrivalTime, j->priority, j->processorTime);
+}
+
+static READY *newReady(int levels, long aging) {
+  READY *r = calloc( 1, sizeof(READY) );
+  assert(r != 0);
+
+  r->levels = levels;
+  r->aging = aging;
+  return r;
+}
+
+/* fcfs and rr: one FIFO */
+
+static void *createFifo(int levels, long aging) {
+  READY *r = newReady(levels, aging);
+  r->fifo = newRUNQ(displayLink);
+  return r;
+}
+
+static int sizeFifo(void *ready) {
+  return sizeRUNQ(((READY *) ready)->fifo);
+}
+
+static void arriveFifo(void *ready, JOB *j) {
+  enqueueRUNQ(((READY *) ready)->fifo, &j->link);
+}
+
+static JOB *pickFifo(void *ready) {
+  READY *r = ready;
+  return sizeRUNQ(r->fifo) ? RUNQ_ENTRY(dequeueRUNQ(r->fifo), JOB, link) : NULL;
+}
+
+static int tickNever(void *ready, JOB *running) {
+  (void) ready;
+  (void) running;
+  return 0;
+}
+
+static int tickRoundRobin(void *ready, JOB *running) {
+  (void) running;
+  return sizeFifo(ready) > 0;
+}
+
+/* mlfq */
+
+static long deadlineOf(JOB *j) {
+  return (j->arrivalTime + (long) j->deadline) * 1000L;
+}
+
+static int compareDeadline(PHNODE *a, PHNODE *b) {
+  JOB *x = PAIRING_ENTRY(a, JOB, node), *y = PAIRING_ENTRY(b, JOB, node);
+  if (deadlineOf(x) != deadlineOf(y))
+    return deadlineOf(x) < deadlineOf(y) ? -1 : 1;
+  return x->id - y->id;
+}
+
+static void *createMlfq(int levels, long aging) {
+  READY *r = newReady(levels, aging);
+  r->mlfq = newMLFQ(levels, displayLink);
+  r->heap = newPAIRING(compareDeadline);
+  return r;
+}
+
+static int sizeMlfq(void *ready) {
+  READY *r = ready;
+  return sizeMLFQ(r->mlfq) + sizePAIRING(r->heap);
+}
+
+/* a user priority past the lowest level joins the lowest level */
+static void arriveMlfq(void *ready, JOB *j) {
+  READY *r = ready;
+
+  if (j->priority >= r->levels)
+    j->priority = r->levels - 1;
+
+  if (j->priority == 0 && j->deadline > 0)
+    insertPAIRING(r->heap, &j->node);
+  else
+    enqueueMLFQ(r->mlfq, j->priority, &j->link);
+}
+
+/* the system level is 0, so it always wins over the user levels */
+static JOB *pickMlfq(void *ready) {
+  READY *r = ready;
+  if (sizePAIRING(r->heap))
+    return PAIRING_ENTRY(extractPAIRING(r->heap), JOB, node);
+  return sizeMLFQ(r->mlfq) ? RUNQ_ENTRY(dequeueMLFQ(r->mlfq), JOB, link) : NULL;
+}
+
+/* an idle CPU is the best place for the most urgent deadline */
+static JOB *stealMlfq(void *ready) {
+  READY *r = ready;
+  if (sizePAIRING(r->heap))
+    return PAIRING_ENTRY(extractPAIRING(r->heap), JOB, node);
+  return sizeMLFQ(r->mlfq) ? RUNQ_ENTRY(stealMLFQ(r->mlfq), JOB, link) : NULL;
+}
+
+static int tickMlfq(void *ready, JOB *running) {
+  return sizeMlfq(ready) > 0 && running->priority != 0;
+}
+
+/* drop a level, never past the lowest */
+static void preemptMlfq(void *ready, JOB *j) {
+  READY *r = ready;
+
+  if (j->priority < r->levels - 1) j->priority += 1;
+  arriveMlfq(ready, j);
+}
+
+/*
+ *Each level is FIFO, so its front job has waited there longest: only the
+ *fronts need checking, and a pass costs O(levels) plus one move per job
+ *promoted, however many jobs are queued. A promoted job starts waiting
+ *afresh at its new level.
+ */
+static void ageMlfq(void *ready, long now) {
+  READY *r = ready;
+  int level;
+
+  if (r->aging <= 0)
+    return;
+
+  for (level = 2; level < r->levels; level++) {
+    while (sizeMLFQlevel(r->mlfq, level) > 0) {
+      RQLINK *link = peekMLFQlevel(r->mlfq, level);
+      JOB *j = RUNQ_ENTRY(link, JOB, link);
+      if (now - j->queuedAt < r->aging)
+        break;
+
+      removeMLFQ(r->mlfq, level, link);
+      j->priority = level - 1;
+      j->queuedAt = now;
+      enqueueMLFQ(r->mlfq, level - 1, link);
+    }
+  }
+}
+
+/* gathers the deadline heap into the admission scratch array */
+static void collectDeadline(PHNODE *node, void *arg) {
+  READY *r = arg;
+  r->scratch[r->gathered++] = PAIRING_ENTRY(node, JOB, node);
+}
+
+static int compareDeadlineOf(const void *a, const void *b) {
+  return compareDeadline(&(*(JOB **) a)->node, &(*(JOB **) b)->node);
+}
+
+/*
+ *Admits a deadline job only if, run earliest deadline first from the
+ *moment the slot is free, it and every deadline job already queued
+ *still finish in time. The queued ones are gathered with one walk of
+ *the heap and sorted, so the test is exact and costs O(k log k) for k
+ *deadline jobs waiting, however many other jobs are queued.
+ */
+static int admitMlfq(void *ready, JOB *j, long now, long blocked) {
+  READY *r = ready;
+  long finish = now + blocked;
+  int i;
+
+  if (j->priority != 0)
+    return 1;
+
+  if (sizePAIRING(r->heap) + 1 > r->scratchSize) {
+    r->scratchSize = 2 * (sizePAIRING(r->heap) + 1);
+    r->scratch = realloc( r->scratch, r->scratchSize * sizeof(JOB *) );
+    assert(r->scratch != 0);
+  }
+
+  r->gathered = 0;
+  walkPAIRING(r->heap, collectDeadline, r);
+  r->scratch[r->gathered++] = j;
+  qsort(r->scratch, r->gathered, sizeof(JOB *), compareDeadlineOf);
+
+  for (i = 0; i < r->gathered; i++) {
+    finish += r->scratch[i]->remainingProcessorTime;
+    if (finish > deadlineOf(r->scratch[i]))
+      return 0;
+  }
+  return 1;
+}
+
+/* sjf and srtf: a pairing heap ordered by processor time or time remaining */
+
+static int compareBurst(PHNODE *a, PHNODE *b) {
+  JOB *x = PAIRING_ENTRY(a, JOB, node), *y = PAIRING_ENTRY(b, JOB, node);
+  if (x->processorTime != y->processorTime)
+    return x->processorTime < y->processorTime ? -1 : 1;
+  return x->id - y->id;
+}
+
+static int compareRemaining(PHNODE *a, PHNODE *b) {
+  JOB *x = PAIRING_ENTRY(a, JOB, node), *y = PAIRING_ENTRY(b, JOB, node);
+  if (x->remainingProcessorTime != y->remainingProcessorTime)
+    return x->remainingProcessorTime < y->remainingProcessorTime ? -1 : 1;
+  return x->id - y->id;
+}
+
+static void *createShortest(int levels, long aging) {
+  READY *r = newReady(levels, aging);
+  r->heap = newPAIRING(compareBurst);
+  return r;
+}
+
+static void *createRemaining(int levels, long aging) {
+  READY *r = newReady(levels, aging);
+  r->heap = newPAIRING(compareRemaining);
+  return r;
+}
+
+static int sizeHeap(void *ready) {
+  return sizePAIRING(((READY *) ready)->heap);
+}
+
+static void arriveHeap(void *ready, JOB *j) {
+  insertPAIRING(((READY *) ready)->heap, &j->node);
+}
+
+static JOB *pickHeap(void *ready) {
+  READY *r = ready;
+  return sizePAIRING(r->heap) ? PAIRING_ENTRY(extractPAIRING(r->heap), JOB, node) : NULL;
+}
+
+static int tickRemaining(void *ready, JOB *running) {
+  READY *r = ready;
+  return sizePAIRING(r->heap) > 0 && compareRemaining(peekPAIRING(r->heap), &running->node) < 0;
+}
+
+/* stride: a pairing heap ordered by pass */
+
+#define STRIDE1 (1L << 20)
+
+static int strideLevel(READY *r, JOB *j) {
+  return j->priority < r->levels ? j->priority : r->levels - 1;
+}
+
+static long strideTickets(READY *r, JOB *j) {
+  return r->levels - strideLevel(r, j);
+}
+
+static int comparePass(PHNODE *a, PHNODE *b) {
+  JOB *x = PAIRING_ENTRY(a, JOB, node), *y = PAIRING_ENTRY(b, JOB, node);
+  if (x->pass != y->pass)
+    return x->pass < y->pass ? -1 : 1;
+  return x->id - y->id;
+}
+
+static void *createStride(int levels, long aging) {
+  READY *r = newReady(levels, aging);
+  r->heap = newPAIRING(comparePass);
+  r->tickets = calloc( levels, sizeof(long) );
+  r->target = calloc( levels, sizeof(double) );
+  r->achieved = calloc( levels, sizeof(double) );
+  assert(r->tickets != 0 && r->target != 0 && r->achieved != 0);
+  return r;
+}
+
+/* a job that has been away, or is new, starts no earlier than the rest */
+static void arriveStride(void *ready, JOB *j) {
+  READY *r = ready;
+
+  if (j->pass < r->pass)
+    j->pass = r->pass;
+  r->tickets[strideLevel(r, j)] += strideTickets(r, j);
+  insertPAIRING(r->heap, &j->node);
+}
+
+/*
+ *Charges a job, whose tickets are still counted as ready, the slice it is
+ *about to run. Before that, each level is owed its fraction of the
+ *tickets now ready, which is what the report holds the slices actually
+ *handed out against. The owed shares cost O(levels).
+ */
+static void chargeStride(READY *r, JOB *j) {
+  long total = 0;
+  int level;
+
+  for (level = 0; level < r->levels; level++)
+    total += r->tickets[level];
+  for (level = 0; level < r->levels; level++)
+    r->target[level] += (double) r->tickets[level] / total;
+
+  r->pass = j->pass;
+  j->pass += STRIDE1 / strideTickets(r, j);
+  r->achieved[strideLevel(r, j)] += 1;
+}
+
+/* takes the lowest pass, O(log n) amortized in the pairing heap */
+static JOB *pickStride(void *ready) {
+  READY *r = ready;
+
+  if (!sizePAIRING(r->heap))
+    return NULL;
+
+  JOB *j = PAIRING_ENTRY(extractPAIRING(r->heap), JOB, node);
+  chargeStride(r, j);
+  r->tickets[strideLevel(r, j)] -= strideTickets(r, j);
+  return j;
+}
+
+/* preempt only for a lower pass, otherwise charge the running job again */
+static int tickStride(void *ready, JOB *running) {
+  READY *r = ready;
+
+  if (sizePAIRING(r->heap) > 0 && comparePass(peekPAIRING(r->heap), &running->node) < 0)
+    return 1;
+
+  r->tickets[strideLevel(r, running)] += strideTickets(r, running);
+  chargeStride(r, running);
+  r->tickets[strideLevel(r, running)] -= strideTickets(r, running);
+  return 0;
+}
+
+static void sharesStride(void *ready, double *target, double *achieved) {
+  READY *r = ready;
+  int level;
+
+  for (level = 0; level < r->levels; level++) {
+    target[level] += r->target[level];
+    achieved[level] += r->achieved[level];
+  }
+}
+
+static POLICY policies[] = {
+  { "fcfs", createFifo, sizeFifo, arriveFifo, pickFifo, NULL, tickNever, arriveFifo, NULL, NULL, NULL, NULL },
+  { "rr", createFifo, sizeFifo, arriveFifo, pickFifo, NULL, tickRoundRobin, arriveFifo, NULL, NULL, NULL, NULL },
+  { "mlfq", createMlfq, sizeMlfq, arriveMlfq, pickMlfq, stealMlfq, tickMlfq, preemptMlfq, NULL, ageMlfq, admitMlfq, NULL },
+  { "sjf", createShortest, sizeHeap, arriveHeap, pickHeap, NULL, tickNever, arriveHeap, NULL, NULL, NULL, NULL },
+  { "srtf", createRemaining, sizeHeap, arriveHeap, pickHeap, NULL, tickRemaining, arriveHeap, NULL, NULL, NULL, NULL },
+  { "stride", createStride, sizeHeap, arriveStride, pickStride, NULL, tickStride, arriveStride, NULL, NULL, NULL, sharesStride },
+};
+
+#define POLICIES ((int) (sizeof(policies) / sizeof(policies[0])))
+
+/*
+ *Returns the policy with the given name, or NULL if there is none
+ */
+POLICY *findPOLICY(char *name) {
+  int i;
+  for (i = 0; i < POLICIES; i++) {
+    if (!strcmp(policies[i].name, name))
+      return &policies[i];
+  }
+  return NULL;
+}
+
+/*
+ *Prints the policy names separated by '|'
+ */
+void listPOLICY(FILE *fp) {
+  int i;
+  for (i = 0; i < POLICIES; i++)
+    fprintf(fp, "%s%s", i ? "|" : "", policies[i].name);
+}
@@ -0,0 +1,47 @@
+/*This file serves as the header for the policy.c file
+ */
+
+#ifndef __POLICY_INCLUDED__
+#define __POLICY_INCLUDED__
+
+#include <stdio.h>
+#include "job.h"
+
+/*
+ *A scheduling policy. Each CPU slot holds its own ready structure made
+ *by create(), and the dispatcher calls the hooks on it:
+ *  arrive    a new job joins
+ *  pick      remove and return the next job to run, NULL if none
+ *  steal     remove a job for an idle slot elsewhere, NULL for pick()
+ *  tick      the running job's slice is over; return 1 to preempt it
+ *  preempt   a preempted job has stopped and joins again
+ *  complete  a job has finished, NULL if nothing to do
+ *  age       called every pass with the time, NULL if nothing to do;
+ *            jobs carry the time they joined in queuedAt
+ *  admit     a job with a deadline is about to arrive at now, after
+ *            blocked ms in which the slot cannot take it; return 0 to
+ *            refuse the deadline, NULL to accept every one
+ *  shares    adds the slice count each level was owed and the count it
+ *            got into target[] and achieved[], NULL if not a
+ *            proportional share policy
+ */
+typedef struct policy POLICY;
+struct policy {
+  char *name;
+  void *(*create)(int levels,long aging);
+  int (*size)(void *ready);
+  void (*arrive)(void *ready,JOB *j);
+  JOB *(*pick)(void *ready);
+  JOB *(*steal)(void *ready);
+  int (*tick)(void *ready,JOB *running);
+  void (*preempt)(void *ready,JOB *j);
+  void (*complete)(void *ready,JOB *j);
+  void (*age)(void *ready,long now);
+  int (*admit)(void *ready,JOB *j,long now,long blocked);
+  void (*shares)(void *ready,double *target,double *achieved);
+};
+
+extern POLICY *findPOLICY(char *name);
+extern void listPOLICY(FILE *);
+
+#endif
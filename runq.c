@@ -0,0 +1,86 @@
+/*This file serves as method implementations for the
+ *intrusive run queue object. The links live inside the
+ *queued objects themselves, so enqueueing, dequeueing and
+ *removing from the middle are O(1) and never allocate.
+ *An object can be on at most one run queue at a time.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <stdlib.h>
+#include "runq.h"
+
+struct runq {
+  RQLINK head;                      // sentinel; head.next is the front
+  int size;
+  void (*display)(FILE *, void *);  // passed the link, not the object
+};
+
+RUNQ *newRUNQ(void (*d)(FILE *, void *)) {
+  assert( sizeof(RUNQ) != 0 );
+
+  RUNQ *q = malloc( sizeof(RUNQ) );
+  assert(q != 0);
+
+  q->head.next = &q->head;
+  q->head.prev = &q->head;
+  q->size = 0;
+  q->display = d;
+
+  return q;
+}
+
+void enqueueRUNQ(RUNQ *items, RQLINK *link) {
+  link->prev = items->head.prev;
+  link->next = &items->head;
+  items->head.prev->next = link;
+  items->head.prev = link;
+  items->size += 1;
+}
+
+RQLINK *dequeueRUNQ(RUNQ *items) {
+  assert( items->size > 0 );
+
+  RQLINK *link = items->head.next;
+  removeRUNQ(items, link);
+
+  return link;
+}
+
+RQLINK *peekRUNQ(RUNQ *items) {
+  assert( items->size > 0 );
+  return items->head.next;
+}
+
+RQLINK *peekRUNQback(RUNQ *items) {
+  assert( items->size > 0 );
+  return items->head.prev;
+}
+
+/*
+ *Unlinks a value from anywhere in the queue. The link must be on this queue.
+ */
+void removeRUNQ(RUNQ *items, RQLINK *link) {
+  assert( items->size > 0 );
+
+  link->prev->next = link->next;
+  link->next->prev = link->prev;
+  link->next = link->prev = NULL;
+  items->size -= 1;
+}
+
+int sizeRUNQ(RUNQ *items) {
+  return items->size;
+}
+
+void displayRUNQ(FILE *fp, RUNQ *items) {
+  fprintf(fp, "<");
+
+  RQLINK *link;
+  for (link = items->head.next; link != &items->head; link = link->next) {
+    items->display(fp, link);
+    if (link->next != &items->head) { fprintf(fp, ","); }
+  }
+
+  fprintf(fp, ">");
+}
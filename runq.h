@@ -0,0 +1,30 @@
+/*This file serves as the header for the runq.c file
+ */
+
+#ifndef __RUNQ_INCLUDED__
+#define __RUNQ_INCLUDED__
+
+#include <stdio.h>
+#include <stddef.h>
+
+typedef struct rqlink RQLINK;
+struct rqlink {
+  RQLINK *next;
+  RQLINK *prev;
+};
+
+/* recovers the object a link is embedded in, e.g. RUNQ_ENTRY(l, JOB, link) */
+#define RUNQ_ENTRY(l,type,member) ((type *) ((char *) (l) - offsetof(type, member)))
+
+typedef struct runq RUNQ;
+
+extern RUNQ *newRUNQ(void (*d)(FILE *,void *));
+extern void enqueueRUNQ(RUNQ *items,RQLINK *link);
+extern RQLINK *dequeueRUNQ(RUNQ *items);
+extern RQLINK *peekRUNQ(RUNQ *items);
+extern RQLINK *peekRUNQback(RUNQ *items);
+extern void removeRUNQ(RUNQ *items,RQLINK *link);
+extern int sizeRUNQ(RUNQ *items);
+extern void displayRUNQ(FILE *,RUNQ *items);
+
+#endif
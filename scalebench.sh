@@ -0,0 +1,68 @@
+#!/bin/sh
+#
+# Runs a synthetic workload through the simulated dispatcher on 1 to 32
+# cores and reports the makespan, the number of stolen jobs and the wall
+# time of each run. The simulated runs measure scheduler throughput only:
+# no process is started, so they say nothing about real-mode scaling.
+#
+# A smaller workload is then run for real on 1 to 8 cores, reporting the
+# wall time, the speedup over one core and the number of stolen jobs.
+# The dispatcher is a single thread, so there are no locks to contend
+# for; what the real runs show is how the cost of spawning, signalling
+# and reaping children grows with the number of cores kept busy, and
+# how often idle cores have to steal.
+#
+# usage: scalebench.sh [jobs] [real jobs]   (default 100000 16; 0 real
+#                                            jobs skips the real runs)
+#
+
+JOBS=${1:-100000}
+REAL=${2:-16}
+INPUT=$(mktemp)
+OUTPUT=$(mktemp)
+trap 'rm -f "$INPUT" "$OUTPUT"' EXIT
+
+# Arrivals spread over the first jobs/100 seconds, a mix of system and user
+# priorities, 1-5 seconds of processor time each
+awk -v n="$JOBS" 'BEGIN {
+	srand(1);
+	for (i = 0; i < n; i++)
+		printf "%d, %d, %d\n", int(i / 100), int(rand() * 4), 1 + int(rand() * 5);
+}' > "$INPUT"
+
+echo "simulated"
+printf "%6s %14s %8s %10s\n" cores makespan steals seconds
+for CORES in 1 2 4 8 16 32
+do
+	START=$(date +%s.%N)
+	OUT=$(./dispatcher -s -c "$CORES" "$INPUT" | tail -2)
+	END=$(date +%s.%N)
+	MAKESPAN=$(echo "$OUT" | awk '/makespan/ { print $1 }')
+	STEALS=$(echo "$OUT" | awk '/steals/ { print $1 }')
+	printf "%6d %14d %8d %10.3f\n" "$CORES" "$MAKESPAN" "$STEALS" "$(echo "$START $END" | awk '{ print $2 - $1 }')"
+done
+
+[ "$REAL" -gt 0 ] || exit 0
+
+# Every job arrives at once with 1-3 seconds to run, so each core stays
+# busy and the ideal wall time halves with each doubling of the cores
+awk -v n="$REAL" 'BEGIN {
+	srand(2);
+	for (i = 0; i < n; i++)
+		printf "0, %d, %d\n", 1 + int(rand() * 3), 1 + int(rand() * 3);
+}' > "$INPUT"
+
+echo
+echo "real"
+printf "%6s %10s %8s %8s\n" cores seconds speedup steals
+for CORES in 1 2 4 8
+do
+	START=$(date +%s.%N)
+	./dispatcher -c "$CORES" "$INPUT" > "$OUTPUT" 2>&1
+	END=$(date +%s.%N)
+	WALL=$(echo "$START $END" | awk '{ print $2 - $1 }')
+	[ "$CORES" -eq 1 ] && BASE=$WALL
+	STEALS=$(awk '/^[0-9]+ steals$/ { print $1 }' "$OUTPUT")    # not printed for one core
+	STEALS=${STEALS:-0}
+	printf "%6d %10.3f %8.2f %8d\n" "$CORES" "$WALL" "$(echo "$BASE $WALL" | awk '{ print $1 / $2 }')" "$STEALS"
+done
@@ -13,6 +13,11 @@
     SIGINT, SIGQUIT, SIGHUP, SIGTERM, SIGABRT, SIGCONT, SIGTSTP
        
   program can not trap SIGSTOP or SIGKILL
+
+  when started by the dispatcher with a control channel (see
+  control.h) the program also parks, resumes and exits on the
+  dispatcher's command, checked once per tick and whenever a
+  command cuts a tick short. signals keep working either way.
    
   to help identify specific processes, the program uses the process
   id to select one of 32 colour combinations for the display to an
@@ -39,6 +44,7 @@
 #include <sys/times.h>
 #include <limits.h>
 #include <sys/resource.h>
+#include "control.h"
  
 #ifndef TRUE
 #define TRUE 1
@@ -51,6 +57,7 @@
 static void SignalHandler(int);
 void        PrintUsage(char*);   // for error exit & info
 char       *StripPath(char*);    // strip path from filename
+static void SafePoint(CONTROL*, FILE*, pid_t);
  
 #define DEFAULT_TIME 20
 #define DEFAULT_OP   stdout
@@ -111,6 +118,7 @@ int main(int argc, char *argv[])
     clock_t starttick, stoptick;
     sigset_t mask;
     FILE * output = DEFAULT_OP;
+    CONTROL * control = openCONTROL(); // NULL when driven by signals only
  
     colour = colours[pid % N_COLOUR]; // select colour for this process
    
@@ -140,9 +148,12 @@ int main(int argc, char *argv[])
             fprintf(output,"%s%7d; SIGCONT" BLACK NORMAL "\n", colour, (int) pid);
             fflush(output);
         }
+
+        if (control)
+            SafePoint(control, output, pid);
            
         starttick = times (&t);        // use timer to ascertain whether 'tick' should be
-        rc = sleep(1);                 //  reported
+        rc = control ? napCONTROL(control, 1000) : (int) sleep(1); //  reported
         stoptick = times (&t);
         
         if (rc == 0 || (stoptick-starttick) > clktck/2)
@@ -228,6 +239,33 @@ static void SignalHandler(int sig)        // trap signals from shell/system
     }
 }
  
+/*******************************************************************
+
+  static void SafePoint(CONTROL * control, FILE * output, pid_t pid)
+
+  obey the dispatcher's command on the control channel: park until
+  told to run again, or exit. reported like the matching signals.
+  a run command that arrived before the first safe point is
+  acknowledged here, as there was no park for it to end.
+
+ *******************************************************************/
+
+static void SafePoint(CONTROL * control, FILE * output, pid_t pid)
+{
+    if (commandCONTROL(control) == CONTROL_PARK) {
+        fprintf(output,"%s%7d; PARK" BLACK NORMAL "\n", colour, (int) pid);
+        fflush(output);
+        parkCONTROL(control);
+        fprintf(output,"%s%7d; RESUME" BLACK NORMAL "\n", colour, (int) pid);
+        fflush(output);
+    }
+    if (commandCONTROL(control) == CONTROL_EXIT) {
+        fprintf(output,"%s%7d; EXIT" BLACK NORMAL "\n", colour, (int) pid);
+        exit(0);
+    }
+    runCONTROL(control);
+}
+
 /*******************************************************************
   
   void PrintUsage(char * pgmName)
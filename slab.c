@@ -0,0 +1,112 @@
+/*This file serves as method implementations for the
+ *slab allocator object, which hands out fixed-size objects
+ *carved from large contiguous slabs. Freed objects go on a
+ *free list threaded through their own memory and are reused
+ *first, so a long-running dispatcher settles into a fixed
+ *footprint. Everything is returned at once by releaseSLAB().
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <stdlib.h>
+#include "slab.h"
+
+#define ALIGNMENT 16
+
+typedef struct chunk CHUNK;
+struct chunk {
+  CHUNK *next;
+  char *objects;
+};
+
+typedef struct freeobject FREEOBJECT;
+struct freeobject {
+  FREEOBJECT *next;
+};
+
+struct slab {
+  int objectSize;
+  int perSlab;
+  int live;
+  int unused;          // never handed out slots left in the newest chunk
+  char *bump;          // next never handed out slot
+  CHUNK *chunks;
+  FREEOBJECT *freeList;
+};
+
+SLAB *newSLAB(int objectSize, int perSlab) {
+  assert( objectSize > 0 && perSlab > 0 );
+
+  SLAB *s = malloc( sizeof(SLAB) );
+  assert(s != 0);
+
+  if (objectSize < (int) sizeof(FREEOBJECT)) { objectSize = sizeof(FREEOBJECT); }
+  s->objectSize = (objectSize + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+  s->perSlab = perSlab;
+  s->live = 0;
+  s->unused = 0;
+  s->bump = NULL;
+  s->chunks = NULL;
+  s->freeList = NULL;
+
+  return s;
+}
+
+void *allocSLAB(SLAB *items) {
+  void *object;
+
+  if (items->freeList) {
+    object = items->freeList;
+    items->freeList = items->freeList->next;
+  }
+  else {
+    if (items->unused == 0) {
+      CHUNK *c = malloc( sizeof(CHUNK) );
+      assert(c != 0);
+      c->objects = aligned_alloc(ALIGNMENT, (size_t) items->objectSize * items->perSlab);
+      assert(c->objects != 0);
+      c->next = items->chunks;
+      items->chunks = c;
+      items->bump = c->objects;
+      items->unused = items->perSlab;
+    }
+
+    object = items->bump;
+    items->bump += items->objectSize;
+    items->unused -= 1;
+  }
+
+  items->live += 1;
+  return object;
+}
+
+void freeSLAB(SLAB *items, void *object) {
+  assert( items->live > 0 );
+
+  FREEOBJECT *f = object;
+  f->next = items->freeList;
+  items->freeList = f;
+  items->live -= 1;
+}
+
+/*
+ *Frees every slab, and with them every object ever allocated, at once.
+ *The allocator itself stays usable.
+ */
+void releaseSLAB(SLAB *items) {
+  while (items->chunks) {
+    CHUNK *c = items->chunks;
+    items->chunks = c->next;
+    free(c->objects);
+    free(c);
+  }
+
+  items->live = 0;
+  items->unused = 0;
+  items->bump = NULL;
+  items->freeList = NULL;
+}
+
+int liveSLAB(SLAB *items) {
+  return items->live;
+}
@@ -0,0 +1,15 @@
+/*This file serves as the header for the slab.c file
+ */
+
+#ifndef __SLAB_INCLUDED__
+#define __SLAB_INCLUDED__
+
+typedef struct slab SLAB;
+
+extern SLAB *newSLAB(int objectSize,int perSlab);
+extern void *allocSLAB(SLAB *items);
+extern void freeSLAB(SLAB *items,void *object);
+extern void releaseSLAB(SLAB *items);
+extern int liveSLAB(SLAB *items);
+
+#endif
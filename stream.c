@@ -0,0 +1,185 @@
+/*This file serves as method implementations for the
+ *job stream object, which feeds job records to a running
+ *dispatcher without ever blocking it. A source is one of:
+ *  -        standard input (a pipe or terminal; a redirected
+ *           regular file is read once)
+ *  a FIFO   opened read-write so writers can come and go
+ *           without the stream reaching end of file
+ *  a file   followed like tail -f, woken by inotify
+ *Records use the job file format and are parsed by parseJOB().
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+#include "stream.h"
+#include "jobfile.h"
+
+#define BUFFER_SIZE 65536
+
+struct stream {
+  char *source;
+  int fd;            // data is read from here
+  int notifyfd;      // inotify instance when following a file, else -1
+  int isOpen;
+  int follow;        // end of file only means "nothing yet"
+  int discarding;    // skipping the rest of an overlong line
+  int lineNumber;
+  int filled;
+  char buffer[BUFFER_SIZE];
+};
+
+STREAM *newSTREAM(char *source) {
+  STREAM *s = malloc( sizeof(STREAM) );
+  assert(s != 0);
+
+  s->source = source;
+  s->notifyfd = -1;
+  s->isOpen = 1;
+  s->follow = 0;
+  s->discarding = 0;
+  s->lineNumber = 0;
+  s->filled = 0;
+
+  struct stat st;
+
+  if (strcmp(source, "-") == 0) {
+    s->fd = STDIN_FILENO;
+    if (fstat(s->fd, &st) == 0 && !S_ISREG(st.st_mode)) {
+      fcntl(s->fd, F_SETFL, fcntl(s->fd, F_GETFL) | O_NONBLOCK);
+    }
+    return s;
+  }
+
+  if (stat(source, &st) < 0) {
+    fprintf(stderr, "Error: Could not open job stream %s\n", source);
+    free(s);
+    return NULL;
+  }
+
+  if (S_ISFIFO(st.st_mode)) {
+    s->fd = open(source, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+  }
+  else {
+    s->fd = open(source, O_RDONLY | O_CLOEXEC);
+    s->notifyfd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (s->notifyfd >= 0) { inotify_add_watch(s->notifyfd, source, IN_MODIFY); }
+    s->follow = 1;
+  }
+
+  if (s->fd < 0) {
+    fprintf(stderr, "Error: Could not open job stream %s\n", source);
+    free(s);
+    return NULL;
+  }
+
+  return s;
+}
+
+/*
+ *Returns the fd whose readability means there may be more records. For a
+ *followed file that is the inotify instance, since regular files are
+ *always readable as far as epoll is concerned.
+ */
+int fdSTREAM(STREAM *s) {
+  return s->notifyfd >= 0 ? s->notifyfd : s->fd;
+}
+
+int openSTREAM(STREAM *s) {
+  return s->isOpen;
+}
+
+/*
+ *Parses complete lines at the start of the buffer, handing at most budget
+ *records to admit. Returns how many were handed over.
+ */
+static int drainLines(STREAM *s, void (*admit)(JOB *), int budget) {
+  int admitted = 0;
+  char *p = s->buffer;
+  char *end = s->buffer + s->filled;
+  char *eol;
+
+  while (admitted < budget && (eol = memchr(p, '\n', end - p)) != NULL) {
+    JOB job;
+
+    if (s->discarding) {
+      s->discarding = 0;
+    }
+    else {
+      s->lineNumber++;
+      switch (parseJOB(p, eol, &job)) {
+        case 1:
+          admit(&job);
+          admitted++;
+          break;
+        case -1:
+          fprintf(stderr, "Error: %s:%d: malformed job record\n", s->source, s->lineNumber);
+          break;
+      }
+    }
+
+    p = eol + 1;
+  }
+
+  s->filled = end - p;
+  memmove(s->buffer, p, s->filled);
+
+  /* a full buffer without a newline can never become a record */
+  if (s->filled == BUFFER_SIZE) {
+    s->lineNumber++;
+    fprintf(stderr, "Error: %s:%d: job record too long\n", s->source, s->lineNumber);
+    s->discarding = 1;
+    s->filled = 0;
+  }
+
+  return admitted;
+}
+
+/*
+ *Reads whatever is available without blocking and hands at most budget
+ *parsed records to admit. Lines beyond the budget stay buffered for the
+ *next call. Returns how many records were handed over.
+ */
+int readSTREAM(STREAM *s, void (*admit)(JOB *), int budget) {
+  int admitted = drainLines(s, admit, budget);
+
+  if (s->notifyfd >= 0) {
+    char events[4096];
+    while (read(s->notifyfd, events, sizeof(events)) > 0)
+      ;
+  }
+
+  while (s->isOpen && admitted < budget) {
+    ssize_t n = read(s->fd, s->buffer + s->filled, BUFFER_SIZE - s->filled);
+
+    if (n > 0) {
+      s->filled += n;
+      admitted += drainLines(s, admit, budget - admitted);
+    }
+    else if (n == 0 && s->follow) {
+      break;
+    }
+    else if (n == 0 || (errno != EAGAIN && errno != EINTR)) {
+      /* the source is finished; a last line without a newline still counts */
+      if (s->filled > 0 && s->filled < BUFFER_SIZE) {
+        s->buffer[s->filled++] = '\n';
+        admitted += drainLines(s, admit, budget - admitted);
+        if (s->filled > 0) { break; }
+      }
+      s->isOpen = 0;
+      close(s->fd);
+      if (s->notifyfd >= 0) { close(s->notifyfd); }
+    }
+    else if (errno == EAGAIN) {
+      break;
+    }
+  }
+
+  return admitted;
+}
@@ -0,0 +1,16 @@
+/*This file serves as the header for the stream.c file
+ */
+
+#ifndef __STREAM_INCLUDED__
+#define __STREAM_INCLUDED__
+
+#include "job.h"
+
+typedef struct stream STREAM;
+
+extern STREAM *newSTREAM(char *source);
+extern int fdSTREAM(STREAM *s);
+extern int readSTREAM(STREAM *s,void (*admit)(JOB *),int budget);
+extern int openSTREAM(STREAM *s);
+
+#endif